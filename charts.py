@@ -22,7 +22,10 @@ df['nodes'] = df['graph_name'].apply(lambda x: parse_graph_name(x)[0])
 df['edges'] = df['graph_name'].apply(lambda x: parse_graph_name(x)[1])
 df['density'] = df['edges'] / df['nodes']
 df['shape_metrics_total_added_bends'] = df['shape_metrics_number_useless_bends'] + df['shape_metrics_bends']
-df['shape_metrics_sat_invocations'] = df['shape_metrics_number_added_cycles'] + df['shape_metrics_total_added_bends'] + 1
+if 'shape_metrics_sat_solves' in df.columns:
+    df['shape_metrics_sat_invocations'] = df['shape_metrics_sat_solves']
+else:
+    df['shape_metrics_sat_invocations'] = df['shape_metrics_number_added_cycles'] + df['shape_metrics_total_added_bends'] + 1
 # df['shape_metrics_ratio_useless_bends'] = df['shape_metrics_number_useless_bends'] / df['shape_metrics_total_added_bends']
 # df['good_bends_ratio'] = df['shape_metrics_bends'] / (df['shape_metrics_bends'] + df['shape_metrics_number_useless_bends'])
 
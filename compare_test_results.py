@@ -49,4 +49,25 @@ if time_diffs:
     print(f"Mean absolute difference for 'shape_metrics_time': {mean_diff}")
     print(f"Max absolute difference for 'shape_metrics_time': {max_diff}")
 else:
-    print("No matching 'graph_name' entries found for 'shape_metrics_time'")
\ No newline at end of file
+    print("No matching 'graph_name' entries found for 'shape_metrics_time'")
+
+# e.g. corners_per_round=1 against a batched run, denser graphs need more solves
+if 'shape_metrics_sat_solves' in df_1.columns and 'shape_metrics_sat_solves' in df_2.columns:
+    merged = df_1.merge(df_2, on='graph_name', suffixes=('_1', '_2'))
+    nodes = merged['graph_name'].str.extract(r'n(\d+)')[0].astype(float)
+    edges = merged['graph_name'].str.extract(r'm(\d+)')[0].astype(float)
+    merged['density'] = edges / nodes
+    for label, rows in [('all', merged), ('density > 1.5', merged[merged['density'] > 1.5])]:
+        if rows.empty:
+            continue
+        print(f"SAT solves ({label}): {rows['shape_metrics_sat_solves_1'].mean()} vs {rows['shape_metrics_sat_solves_2'].mean()}")
+        print(f"Bends ({label}): {rows['shape_metrics_bends_1'].mean()} vs {rows['shape_metrics_bends_2'].mean()}")
+
+# e.g. break_symmetries=false against true, on rome_2/ and on generated-graphs/
+if 'shape_metrics_sat_conflicts' in df_1.columns and 'shape_metrics_sat_conflicts' in df_2.columns:
+    merged = df_1.merge(df_2, on='graph_name', suffixes=('_1', '_2'))
+    for column in ['shape_metrics_sat_conflicts', 'shape_metrics_sat_time']:
+        total_1 = merged[column + '_1'].sum()
+        total_2 = merged[column + '_2'].sum()
+        print(f"Total {column}: {total_1} vs {total_2}")
+        print(f"Median {column}: {merged[column + '_1'].median()} vs {merged[column + '_2'].median()}")
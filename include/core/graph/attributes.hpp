@@ -2,8 +2,10 @@
 #define MY_GRAPH_ATTRIBUTES_H
 
 #include <any>
+#include <memory_resource>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "core/utils.hpp"
@@ -22,11 +24,15 @@ enum class Attribute {
 
 class GraphAttributes {
  private:
-  std::unordered_map<Attribute, std::unordered_map<int, std::any>>
+  std::pmr::unordered_map<Attribute, std::pmr::unordered_map<int, std::any>>
       mattribute_to_node;
-  IntPairHashSet m_identified_nodes;
+  std::pmr::unordered_set<std::pair<int, int>, int_pair_hash>
+      m_identified_nodes;
 
  public:
+  GraphAttributes() = default;
+  explicit GraphAttributes(std::pmr::memory_resource* resource)
+      : mattribute_to_node(resource), m_identified_nodes(resource) {}
   bool has_attribute(Attribute attribute) const;
   void add_attribute(Attribute attribute);
   bool has_attribute_by_id(Attribute attribute, int id) const;
@@ -0,0 +1,53 @@
+#ifndef MY_FROZEN_GRAPH_H
+#define MY_FROZEN_GRAPH_H
+
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+
+// read-only compressed sparse row snapshot of a graph, nodes get the dense
+// indices 0..size()-1 in the order of Graph::get_nodes and the neighbors of
+// each node keep the order of GraphNode::get_edges
+class FrozenGraph {
+ private:
+  // built by GraphBuilder, which has already checked nodes and edges
+  FrozenGraph(const std::vector<int>& node_ids,
+              const std::vector<std::pair<int, int>>& edges);
+  friend class GraphBuilder;
+  std::vector<int> m_index_to_id;
+  // indexed by node id, -1 for ids that are not in the graph; empty when the
+  // ids are far more than the nodes, then the hash map is used instead
+  std::vector<int> m_id_to_index;
+  std::unordered_map<int, int> m_sparse_id_to_index;
+  void build_id_index();
+  std::vector<int> m_offsets;
+  std::vector<int> m_targets;
+
+ public:
+  explicit FrozenGraph(const Graph& graph);
+  int size() const { return m_index_to_id.size(); }
+  int get_number_of_edges() const { return m_targets.size(); }
+  // -1 if the node is not in the graph
+  int find_index(int id) const {
+    if (id >= 0 && id < (int)m_id_to_index.size()) return m_id_to_index[id];
+    if (m_sparse_id_to_index.empty()) return -1;
+    auto it = m_sparse_id_to_index.find(id);
+    return (it != m_sparse_id_to_index.end()) ? it->second : -1;
+  }
+  bool has_node(int id) const { return find_index(id) != -1; }
+  int get_index(int id) const;
+  int get_id(int index) const { return m_index_to_id[index]; }
+  std::span<const int> get_neighbors(int index) const {
+    return {m_targets.data() + m_offsets[index],
+            m_targets.data() + m_offsets[index + 1]};
+  }
+  int get_degree(int index) const {
+    return m_offsets[index + 1] - m_offsets[index];
+  }
+  bool has_edge(int from_index, int to_index) const;
+};
+
+#endif
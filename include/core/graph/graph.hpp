@@ -1,82 +1,168 @@
 #ifndef MY_GRAPH_H
 #define MY_GRAPH_H
 
+#include <deque>
 #include <memory>
+#include <memory_resource>
 #include <ranges>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "core/small_vector.hpp"
 #include "core/utils.hpp"
 
 class GraphNode;
 class Graph;
+class GraphBuilder;
 
+// nodes and edges reach their graph through its owner cell (see Graph) and
+// refer to other nodes by id, so they survive moves of the graph
 class GraphEdge {
  private:
-  const int m_id;
-  const GraphNode& m_from;
-  const GraphNode& m_to;
-  const Graph& m_graph_owner;
+  int m_id;
+  int m_from_id;
+  int m_to_id;
+  const Graph* const* m_graph_owner;
+  friend class Graph;
 
  public:
   GraphEdge(int id, const GraphNode& from, const GraphNode& to,
             const Graph& owner);
-  const GraphNode& get_to() const { return m_to; }
-  const GraphNode& get_from() const { return m_from; }
+  const GraphNode& get_to() const;
+  const GraphNode& get_from() const;
   int get_id() const { return m_id; }
   const std::string to_string() const;
-  const Graph& get_owner() const { return m_graph_owner; }
+  const Graph& get_owner() const { return **m_graph_owner; }
   void print() const { std::cout << to_string() << std::endl; }
 };
 
+class GraphNode {
+ private:
+  int m_id;
+  const Graph* const* m_graph_owner;
+  friend class Graph;
+
+ public:
+  GraphNode(int id, const Graph& owner);
+  int get_id() const { return m_id; }
+  std::string to_string() const;
+  auto get_edges() const;
+  int get_degree() const;
+  int get_in_degree() const;
+  void print() const { std::cout << to_string() << std::endl; }
+  const Graph& get_owner() const { return **m_graph_owner; }
+};
+
+// nodes live in slots of a deque, so references to them stay valid while the
+// graph grows, node ids are mapped to slots (by a vector while the ids are
+// about as many as the nodes, by a hash map for the few far larger ones) and
+// the slots of removed nodes are reused; edge ids are the slots of their
+// edges and the ids of removed edges are reused; all of it is allocated from
+// the memory resource given at construction; moves only update the owner
+// cell, clone copies the slots as they are
 class Graph {
  private:
+  struct Incidence {
+    int neighbor_id;
+    int edge_id;
+  };
+  struct NodeSlot {
+    GraphNode node;
+    // degree 4 is the common case once the graph is drawn
+    SmallVector<Incidence, 4> out_edges;
+    SmallVector<Incidence, 4> in_edges;
+    int position;  // index in m_node_order
+  };
+  struct EdgeSlot {
+    GraphEdge edge;
+    int position;  // index in m_edge_order, -1 if the slot is free
+  };
+  // heap cell with the address of the graph, nodes and edges point to it
+  std::unique_ptr<const Graph*> m_owner_cell;
   int m_next_node_id = 0;
-  int m_next_edge_id = 0;
-  std::unordered_map<int, std::unique_ptr<GraphNode>> m_nodeid_to_node_map;
-  std::unordered_map<int, std::unordered_set<int>> m_nodeid_to_edgesid;
-  std::unordered_map<int, std::unordered_map<int, int>>
-      m_nodeid_to_neighborsid_to_edgesid;
-  std::unordered_map<int, std::unique_ptr<GraphEdge>> m_edgeid_to_edge_map;
-  std::unordered_map<int, std::unordered_set<int>>
-      m_nodeid_to_incoming_edgesid_map;
+  std::pmr::vector<int> m_nodeid_to_slot;  // -1 for ids not in the graph
+  std::pmr::unordered_map<int, int> m_sparse_nodeid_to_slot;
+  std::pmr::deque<NodeSlot> m_node_slots;
+  std::pmr::vector<int> m_free_node_slots;
+  std::pmr::vector<int> m_node_order;  // slots of the nodes in the graph
+  std::pmr::deque<EdgeSlot> m_edge_slots;
+  std::pmr::vector<int> m_free_edge_ids;
+  std::pmr::vector<int> m_edge_order;  // ids of the edges in the graph
+  // -1 if the node is not in the graph
+  int find_slot(int node_id) const {
+    if (node_id >= 0 && node_id < (int)m_nodeid_to_slot.size() &&
+        m_nodeid_to_slot[node_id] != -1)
+      return m_nodeid_to_slot[node_id];
+    if (m_sparse_nodeid_to_slot.empty()) return -1;
+    auto it = m_sparse_nodeid_to_slot.find(node_id);
+    return (it != m_sparse_nodeid_to_slot.end()) ? it->second : -1;
+  }
+  const NodeSlot& get_slot(int node_id) const {
+    return m_node_slots[find_slot(node_id)];
+  }
+  NodeSlot& get_slot(int node_id) {
+    return m_node_slots[find_slot(node_id)];
+  }
+  static int find_incidence(const SmallVector<Incidence, 4>& incidences,
+                            int neighbor_id);
+  // the callers have already checked ids and edges
+  const GraphNode& add_node_unchecked(int id);
+  const GraphEdge& add_edge_unchecked(int from_id, int to_id);
+  void clear();
+  friend class GraphBuilder;
+  friend class GraphNode;
+  friend class GraphEdge;
 
  public:
-  Graph() {}
-  bool has_node(int id) const { return m_nodeid_to_node_map.contains(id); }
+  Graph() : Graph(std::pmr::get_default_resource()) {}
+  explicit Graph(std::pmr::memory_resource* resource)
+      : m_owner_cell(std::make_unique<const Graph*>(this)),
+        m_nodeid_to_slot(resource),
+        m_sparse_nodeid_to_slot(resource),
+        m_node_slots(resource),
+        m_free_node_slots(resource),
+        m_node_order(resource),
+        m_edge_slots(resource),
+        m_free_edge_ids(resource),
+        m_edge_order(resource) {}
+  bool has_node(int id) const { return find_slot(id) != -1; }
   const GraphNode& get_node_by_id(int id) const;
   auto get_nodes() const {
-    return m_nodeid_to_node_map |
-           std::views::transform([](const auto& pair) -> const GraphNode& {
-             return *pair.second;
+    return m_node_order |
+           std::views::transform([this](int slot) -> const GraphNode& {
+             return m_node_slots[slot].node;
            });
   }
   auto get_nodes_ids() const {
-    return m_nodeid_to_node_map |
-           std::views::transform(
-               [](const auto& pair) -> int { return pair.first; });
+    return m_node_order | std::views::transform([this](int slot) -> int {
+             return m_node_slots[slot].node.get_id();
+           });
   }
   auto get_edges_of_node(int node_id) const {
     if (!has_node(node_id))
       throw std::runtime_error("Graph::get_edges: node not found");
-    return m_nodeid_to_edgesid.at(node_id) |
-           std::views::transform([this](int edge_id) -> const GraphEdge& {
-             return *m_edgeid_to_edge_map.at(edge_id);
-           });
+    return get_slot(node_id).out_edges.as_span() |
+           std::views::transform(
+               [this](const Incidence& incidence) -> const GraphEdge& {
+                 return m_edge_slots[incidence.edge_id].edge;
+               });
   }
   const GraphNode& add_node(int id);
   const GraphNode& add_node();
+  void reserve(int number_of_nodes, int number_of_edges);
   const GraphEdge& add_edge(int from_id, int to_id);
   bool has_edge(int from_id, int to_id) const;
   void add_undirected_edge(int from_id, int to_id);
-  int size() const { return m_nodeid_to_node_map.size(); }
-  int get_number_of_edges() const;
+  int size() const { return m_node_order.size(); }
+  int get_number_of_edges() const { return m_edge_order.size(); }
   int get_edge_id(int from_id, int to_id) const;
   auto get_edges() const {
-    return m_edgeid_to_edge_map |
-           std::views::transform([](const auto& pair) -> const GraphEdge& {
-             return *pair.second;
+    return m_edge_order |
+           std::views::transform([this](int edge_id) -> const GraphEdge& {
+             return m_edge_slots[edge_id].edge;
            });
   }
   int get_degree_of_node(int node_id) const;
@@ -88,31 +174,39 @@ class Graph {
   void remove_undirected_edge(int from_id, int to_id);
   const std::string to_string() const;
   void print() const { std::cout << to_string() << std::endl; }
-  // delete move constructor and move assignment operator
+  std::pmr::memory_resource* get_memory_resource() const {
+    return m_node_order.get_allocator().resource();
+  }
+  // same ids, order and free slots, no hashing or checks
+  Graph clone(std::pmr::memory_resource* resource =
+                  std::pmr::get_default_resource()) const;
+  // copies are explicit, through clone
   Graph(const Graph&) = delete;
   Graph& operator=(const Graph&) = delete;
-  // delete copy constructor and copy assignment operator
-  Graph(Graph&&) = delete;
-  Graph& operator=(Graph&&) = delete;
+  // the moved-from graph is left empty
+  Graph(Graph&& other);
+  Graph& operator=(Graph&& other);
 };
 
-class GraphNode {
- private:
-  int m_id;
-  const Graph& m_graph_owner;
+inline const GraphNode& GraphEdge::get_to() const {
+  return (*m_graph_owner)->get_node_by_id(m_to_id);
+}
 
- public:
-  GraphNode(int id, const Graph& owner) : m_id(id), m_graph_owner(owner) {}
-  int get_id() const { return m_id; }
-  std::string to_string() const;
-  auto get_edges() const { return m_graph_owner.get_edges_of_node(m_id); };
-  int get_degree() const { return get_edges().size(); }
-  int get_in_degree() const {
-    return m_graph_owner.get_in_degree_of_node(m_id);
-  }
-  void print() const { std::cout << to_string() << std::endl; }
-  const Graph& get_owner() const { return m_graph_owner; }
-};
+inline const GraphNode& GraphEdge::get_from() const {
+  return (*m_graph_owner)->get_node_by_id(m_from_id);
+}
+
+inline auto GraphNode::get_edges() const {
+  return (*m_graph_owner)->get_edges_of_node(m_id);
+}
+
+inline int GraphNode::get_degree() const {
+  return (*m_graph_owner)->get_degree_of_node(m_id);
+}
+
+inline int GraphNode::get_in_degree() const {
+  return (*m_graph_owner)->get_in_degree_of_node(m_id);
+}
 
 using GraphEdgeHashSet = std::unordered_set<std::pair<int, int>, int_pair_hash>;
 
@@ -0,0 +1,41 @@
+#ifndef MY_GRAPH_BUILDER_H
+#define MY_GRAPH_BUILDER_H
+
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "core/graph/frozen_graph.hpp"
+#include "core/graph/graph.hpp"
+
+// collects nodes and edges in bulk without checking them one by one,
+// finalize validates everything once and throws on negative or repeated node
+// ids, edges with a missing endpoint and repeated edges
+class GraphBuilder {
+ private:
+  std::vector<int> m_nodes;
+  std::vector<std::pair<int, int>> m_edges;
+  void validate() const;
+
+ public:
+  void reserve(int number_of_nodes, int number_of_edges);
+  void add_node(int id) { m_nodes.push_back(id); }
+  void add_edge(int from_id, int to_id) { m_edges.push_back({from_id, to_id}); }
+  void add_undirected_edge(int from_id, int to_id) {
+    add_edge(from_id, to_id);
+    add_edge(to_id, from_id);
+  }
+  // nodes and edges of graph, which is already known to be valid
+  void add_graph(const Graph& graph);
+  int size() const { return m_nodes.size(); }
+  int get_number_of_edges() const { return m_edges.size(); }
+  std::unique_ptr<Graph> finalize(
+      std::pmr::memory_resource* resource =
+          std::pmr::get_default_resource()) const;
+  // graph must be empty
+  void finalize(Graph& graph) const;
+  FrozenGraph finalize_frozen() const;
+};
+
+#endif
@@ -2,12 +2,17 @@
 #define MY_GRAPHS_ALGORITHMS_H
 
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
+#include "core/graph/frozen_graph.hpp"
 #include "core/graph/graph.hpp"
 
 bool is_graph_connected(const Graph& graph);
 
+bool is_graph_connected(const FrozenGraph& graph);
+
 bool is_graph_undirected(const Graph& graph);
 
 std::vector<std::vector<int>> compute_all_cycles_with_node_in_undirected_graph(
@@ -19,8 +24,41 @@ std::vector<std::vector<int>> compute_all_cycles_in_undirected_graph(
 
 std::optional<std::vector<int>> find_a_cycle_directed_graph(const Graph& graph);
 
+// cycles that share no edge, the graph is acyclic once all their edges are
+// removed
+std::vector<std::vector<int>> find_edge_disjoint_cycles_directed_graph(
+    const Graph& graph);
+
 std::vector<std::vector<int>> compute_cycle_basis(const Graph& graph);
 
+// same cycles as the Graph overload, the spanning tree is a bfs from index 0
+// (one per connected component) kept as parent and depth arrays
+std::vector<std::vector<int>> compute_cycle_basis(const FrozenGraph& graph);
+
+// cycles stored back to back, cycle k is nodes[offsets[k]..offsets[k + 1])
+struct FlatCycles {
+  std::vector<int> offsets{0};
+  std::vector<int> nodes;
+  int get_number_of_cycles() const;
+  std::span<const int> get_cycle(int cycle) const;
+  std::vector<std::vector<int>> to_vectors() const;
+};
+
+// the cycles of compute_cycle_basis in one buffer, the common ancestor of the
+// endpoints of each non-tree edge is found by binary lifting in O(log n)
+FlatCycles compute_flat_cycle_basis(const Graph& graph);
+
+FlatCycles compute_flat_cycle_basis(const FrozenGraph& graph);
+
+// a cycle basis of minimum total length, so with shorter cycles than the bfs
+// one; it tries a candidate cycle per node and independent cycle, so time
+// grows more than cubically, and above a few million candidates the bfs basis
+// is returned instead
+std::vector<std::vector<int>> compute_minimum_cycle_basis(const Graph& graph);
+
+std::vector<std::vector<int>> compute_minimum_cycle_basis(
+    const FrozenGraph& graph);
+
 std::vector<int> make_topological_ordering(const Graph& graph);
 
 int compute_embedding_genus(int number_of_nodes, int number_of_edges,
@@ -41,6 +79,32 @@ struct BiconnectedComponents {
 
 BiconnectedComponents compute_biconnected_components(const Graph& graph);
 
+BiconnectedComponents compute_biconnected_components(const FrozenGraph& graph);
+
+// blocks and cut vertices of an undirected graph in flat arrays, block k owns
+// the ranges [offsets[k], offsets[k + 1]) of its nodes and edges (each
+// undirected edge once), the tree edges link every cut vertex to its blocks;
+// an isolated node is a block with no edges
+struct BlockCutTree {
+  std::vector<int> block_node_offsets{0};
+  std::vector<int> block_nodes;
+  std::vector<int> block_edge_offsets{0};
+  std::vector<std::pair<int, int>> block_edges;
+  std::vector<int> cut_vertices;
+  std::vector<int> cut_vertex_block_offsets{0};
+  std::vector<int> cut_vertex_blocks;
+  int get_number_of_blocks() const;
+  std::span<const int> get_block_nodes(int block) const;
+  std::span<const std::pair<int, int>> get_block_edges(int block) const;
+  // position is the index of the cut vertex in cut_vertices
+  std::span<const int> get_blocks_of_cut_vertex(int position) const;
+};
+
+BlockCutTree compute_block_cut_tree(const Graph& graph);
+
+// without recursion, so deep dfs trees (long paths) do not overflow the stack
+BlockCutTree compute_block_cut_tree(const FrozenGraph& graph);
+
 std::pair<std::unique_ptr<Graph>, GraphEdgeHashSet>
 compute_maximal_degree_4_subgraph(const Graph& graph);
 
@@ -0,0 +1,22 @@
+#ifndef MY_PLANARITY_H
+#define MY_PLANARITY_H
+
+#include <optional>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+
+// the faces of a planar embedding (computed with ogdf) of an undirected
+// graph, as simple cycles: facial walks through cut vertices are split and
+// bridges dropped, cycles bounding two faces are kept once; nullopt if the
+// graph is not planar
+std::optional<std::vector<std::vector<int>>> compute_planar_faces_cycles(
+    const Graph& graph);
+
+// splits a closed walk, given without repeating its first node, into the
+// simple cycles it goes around; the back and forth steps over bridges, which
+// close no cycle, are dropped
+std::vector<std::vector<int>> split_closed_walk_into_cycles(
+    const std::vector<int>& walk);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef MY_SMALL_VECTOR_H
+#define MY_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// vector that keeps up to N elements inline and spills over to the memory
+// resource only once it grows past them, T must be trivially copyable; copies
+// and moves keep the resource of the vector they are made from, assignments
+// the one of the vector assigned to
+template <typename T, int N>
+class SmallVector {
+ private:
+  T m_inline[N];
+  std::pmr::vector<T> m_spill;
+  int m_size = 0;
+  bool is_spilled() const { return m_size > N || !m_spill.empty(); }
+
+ public:
+  SmallVector() = default;
+  explicit SmallVector(std::pmr::memory_resource* resource)
+      : m_spill(resource) {}
+  SmallVector(const SmallVector& other, std::pmr::memory_resource* resource)
+      : m_spill(resource) {
+    *this = other;
+  }
+  SmallVector(const SmallVector&) = default;
+  SmallVector(SmallVector&&) = default;
+  SmallVector& operator=(const SmallVector&) = default;
+  SmallVector& operator=(SmallVector&&) = default;
+  int size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  const T* data() const { return is_spilled() ? m_spill.data() : m_inline; }
+  T* data() { return is_spilled() ? m_spill.data() : m_inline; }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + m_size; }
+  const T& operator[](int index) const { return data()[index]; }
+  T& operator[](int index) { return data()[index]; }
+  std::span<const T> as_span() const { return {data(), data() + m_size}; }
+  void push_back(const T& value) {
+    if (m_size == N && m_spill.empty())
+      m_spill.assign(m_inline, m_inline + N);
+    if (is_spilled())
+      m_spill.push_back(value);
+    else
+      m_inline[m_size] = value;
+    ++m_size;
+  }
+  // keeps the order of the other elements
+  void erase_at(int index) {
+    T* elements = data();
+    std::copy(elements + index + 1, elements + m_size, elements + index);
+    --m_size;
+    if (is_spilled()) m_spill.pop_back();
+  }
+  void clear() {
+    m_spill.clear();
+    m_size = 0;
+  }
+};
+
+#endif
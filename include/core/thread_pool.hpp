@@ -0,0 +1,51 @@
+#ifndef MY_THREAD_POOL_H
+#define MY_THREAD_POOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// threads that live as long as the pool and run the tasks given to run; the
+// caller of run works on its own tasks too, so a task can call run again
+// without waiting for a free thread, and the newest tasks are served first,
+// so that nested ones finish before the outer ones go on
+class ThreadPool {
+ private:
+  struct Batch {
+    const std::function<void(int)>* task;
+    int number_of_tasks;
+    int next_task;
+    int unfinished_tasks;
+    std::exception_ptr error;
+  };
+  std::mutex m_mutex;
+  std::condition_variable m_task_added;
+  std::condition_variable m_task_finished;
+  // batches with tasks not started yet, the newest last
+  std::vector<Batch*> m_batches;
+  std::vector<std::thread> m_threads;
+  bool m_stopping = false;
+  void run_thread();
+  // starts the next task of batch, lock is held before and after
+  void run_task(Batch& batch, std::unique_lock<std::mutex>& lock);
+
+ public:
+  // number_of_threads besides the callers of run
+  explicit ThreadPool(int number_of_threads);
+  ~ThreadPool();
+  // runs task(0), ..., task(number_of_tasks - 1), roughly in this order, and
+  // returns once all of them are done; the first exception is rethrown
+  void run(int number_of_tasks, const std::function<void(int)>& task);
+  int get_number_of_threads() const { return m_threads.size(); }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+// one thread per hardware thread, the caller's included, created on first
+// use; whoever runs tasks on it shares the same threads
+ThreadPool& get_thread_pool();
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef MY_DRAWING_BENCHMARK_H
+#define MY_DRAWING_BENCHMARK_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+#include "orthogonal/drawing_builder.hpp"
+
+double elapsed_seconds(std::chrono::steady_clock::time_point start);
+
+// options a benchmark draws every graph with, name is their value in the csv
+struct DrawingSetting {
+  std::string name;
+  DrawingOptions options;
+};
+
+// a column a benchmark adds after the setting, computed before the drawing
+struct DrawingColumn {
+  std::string name;
+  std::function<long long(const Graph&, const DrawingOptions&)> compute;
+};
+
+// draws every connected graph of the folder once per setting, printing one
+// csv row per graph and setting and then the totals of each setting;
+// setting_column is the csv header of the setting names
+void run_drawing_benchmark(const std::string& folder,
+                           const std::string& setting_column,
+                           const std::vector<DrawingSetting>& settings,
+                           const std::vector<DrawingColumn>& columns = {});
+
+#endif
@@ -2,7 +2,9 @@
 #define MY_DRAWING_BUILDER_H
 
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -49,6 +51,9 @@ void node_positions_to_svg(const NodesPositions& positions, const Graph& graph,
                            const std::string& filename);
 
 struct DrawingResult {
+  // the graph, attributes and shape below are allocated from it, it comes
+  // first so that it is released last and all at once
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> memory;
   std::unique_ptr<Graph> augmented_graph;
   GraphAttributes attributes;
   Shape shape;
@@ -56,14 +61,55 @@ struct DrawingResult {
   int initial_number_of_cycles;
   int number_of_added_cycles;
   int number_of_useless_bends;
+  SatStats sat_stats;
+  // a solve ran out of its budget or the last solve used up the drawing's,
+  // so edges were split more aggressively than usual; a drawing whose budget
+  // is used up before its shape throws DrawingBudgetExhausted instead
+  bool sat_budget_exhausted = false;
+  // the blocks were solved but could not be glued, so the whole graph was
+  // drawn at once; the solves of the blocks are counted in sat_stats too
+  bool has_discarded_blocks = false;
 };
 
-DrawingResult make_orthogonal_drawing(const Graph& graph);
+// cycles the shape starts from: the fundamental cycles of a bfs tree, a
+// basis of minimum total length whose short cycles give narrower clauses (bfs
+// on large graphs, see compute_minimum_cycle_basis), or
+// the faces of a planar embedding (bfs when the graph is not planar), which
+// leave few cycles for the metrics checks to add
+enum class CycleBasisType { BFS, MINIMUM, FACES };
+
+const std::string cycle_basis_type_to_string(const CycleBasisType type);
+
+CycleBasisType string_to_cycle_basis_type(const std::string& type);
+
+std::vector<std::vector<int>> compute_initial_cycles(const Graph& graph,
+                                                     CycleBasisType type);
+
+struct DrawingOptions {
+  ShapeOptions shape_options;
+  CycleBasisType cycle_basis = CycleBasisType::BFS;
+  // add every edge-disjoint cycle of the orderings after each shape, instead
+  // of only the first one found
+  bool add_all_conflicting_cycles = false;
+  // draw the biconnected blocks on their own, in parallel on get_thread_pool()
+  // (so sharing its threads with callers that draw graphs on it too), and
+  // glue them at the cut vertices; the whole graph is drawn at once when it
+  // has a node of degree more than 4 or when the blocks cannot be glued
+  bool solve_blocks_in_parallel = false;
+};
+
+// throws DrawingBudgetExhausted when shape_options.seconds_per_drawing is
+// used up, as make_orthogonal_drawing_sperimental
+DrawingResult make_orthogonal_drawing(const Graph& graph,
+                                      const DrawingOptions& options = {});
 
 bool check_if_drawing_has_overlappings(const Graph& graph,
                                        const NodesPositions& positions);
 
-DrawingResult make_orthogonal_drawing_sperimental(const Graph& graph);
+// throws DrawingBudgetExhausted when shape_options.seconds_per_drawing is
+// used up
+DrawingResult make_orthogonal_drawing_sperimental(
+    const Graph& graph, const DrawingOptions& options = {});
 
 void add_back_removed_edge(DrawingResult& result,
                            const std::pair<int, int>& edge);
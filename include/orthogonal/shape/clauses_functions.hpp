@@ -1,6 +1,9 @@
 #ifndef MY_CLAUSES_FUNCTIONS_H
 #define MY_CLAUSES_FUNCTIONS_H
 
+#include <optional>
+#include <utility>
+
 #include "core/graph/graph.hpp"
 #include "orthogonal/shape/variables_handler.hpp"
 #include "sat/cnf_builder.hpp"
@@ -8,27 +11,64 @@
 // each edge can only be in one direction
 void add_constraints_one_direction_per_edge(const Graph& graph,
                                             CnfBuilder& cnf_builder,
-                                            const VariablesHandler& handler);
+                                            VariablesHandler& handler);
+
+// the edge (i, j) can only be in one direction
+void add_constraints_one_direction_for_edge(int i, int j,
+                                            CnfBuilder& cnf_builder,
+                                            VariablesHandler& handler);
 
 // at least one neighbor of node is in the direction
 void add_clause_at_least_one_in_direction(CnfBuilder& cnf_builder,
+                                          VariablesHandler& handler,
+                                          const GraphNode& node,
+                                          Direction direction);
+
+// no two neighbors of node are in the direction
+void add_clauses_at_most_one_in_direction(CnfBuilder& cnf_builder,
                                           const VariablesHandler& handler,
                                           const GraphNode& node,
                                           Direction direction);
 
 // no two neighbors of node can be in the same direction
 void add_one_edge_per_direction_clauses(CnfBuilder& cnf_builder,
-                                        const VariablesHandler& handler,
+                                        VariablesHandler& handler,
                                         const Direction direction,
                                         const GraphNode& node);
 
+// constraints of a single node in degree 4 graphs
+void add_node_constraints(const GraphNode& node, CnfBuilder& cnf_builder,
+                          VariablesHandler& handler);
+
 // constraints of nodes in degree 4 graphs
 void add_nodes_constraints(const Graph& graph, CnfBuilder& cnf_builder,
-                           const VariablesHandler& handler);
+                           VariablesHandler& handler);
+
+// constraints from a single cycle in degree 4 graphs
+void add_cycle_constraints(CnfBuilder& cnf_builder,
+                           const std::vector<int>& cycle,
+                           VariablesHandler& handler);
 
 // constraints from cycles in degree 4 graphs
 void add_cycles_constraints(const Graph& graph, CnfBuilder& cnf_builder,
                             const std::vector<std::vector<int>>& cycles,
-                            const VariablesHandler& handler);
+                            VariablesHandler& handler);
+
+// no edge leaves node in the directions, one bit per direction
+void add_forbidden_directions_clauses(const GraphNode& node, int directions,
+                                      CnfBuilder& cnf_builder,
+                                      const VariablesHandler& handler);
+
+// every shape can be rotated and mirrored into one where the first edge of
+// the node of highest degree goes right and its second edge does not go down,
+// the clauses keep only those shapes; returns the edge that goes right
+std::optional<std::pair<int, int>> add_symmetry_breaking_clauses(
+    const Graph& graph, CnfBuilder& cnf_builder,
+    const VariablesHandler& handler);
+
+// the same clauses with the given node in place of the one of highest degree
+std::optional<std::pair<int, int>> add_symmetry_breaking_clauses_at_node(
+    const GraphNode& node, CnfBuilder& cnf_builder,
+    const VariablesHandler& handler);
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define MY_SHAPE_HPP
 
 #include <array>
+#include <memory_resource>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -25,9 +26,12 @@ constexpr std::array<Direction, 4> get_all_directions() {
 
 class Shape {
  private:
-  std::unordered_map<std::pair<int, int>, Direction, int_pair_hash> m_shape;
+  std::pmr::unordered_map<std::pair<int, int>, Direction, int_pair_hash>
+      m_shape;
 
  public:
+  Shape() = default;
+  explicit Shape(std::pmr::memory_resource* resource) : m_shape(resource) {}
   void set_direction(const int i, const int j, const Direction direction);
   Direction get_direction(const int i, const int j) const;
   bool contains(const int i, const int j) const;
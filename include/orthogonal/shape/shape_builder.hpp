@@ -1,14 +1,137 @@
 #ifndef MY_SHAPE_BUILDER_H
 #define MY_SHAPE_BUILDER_H
 
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 #include "core/graph/attributes.hpp"
 #include "core/graph/graph.hpp"
 #include "orthogonal/shape/shape.hpp"
+#include "orthogonal/shape/variables_handler.hpp"
+#include "sat/cnf_builder.hpp"
+#include "sat/sat_solver.hpp"
 
+struct ShapeOptions {
+  SatBackend sat_backend = DEFAULT_SAT_BACKEND;
+  bool randomize = false;
+  // keep one solver alive while corners are added, instead of rebuilding the
+  // whole formula after every UNSAT; the edges to split come from the UNSAT
+  // core, so backends that do not report one rebuild the formula anyway
+  bool incremental = false;
+  // pick the edge to split from the unit clauses of the DRUP proof instead of
+  // the UNSAT core, always done with backends that do not report cores
+  bool split_from_proof = false;
+  DirectionEncoding direction_encoding = DirectionEncoding::ONE_HOT;
+  // give every edge an optional corner and find the fewest corners with a
+  // MaxSAT search, instead of adding corners one UNSAT at a time; cannot be
+  // combined with incremental; a search cut short by the budget keeps its
+  // best shape and is counted in SatStats::number_of_unproven_optima
+  bool minimize_bends = false;
+  // number of differently seeded solvers racing on every formula
+  int portfolio_size = 1;
+  // edges split after every UNSAT, taken from the same core or unit clauses
+  // that would give the single edge; 0 splits all of them
+  int corners_per_round = 1;
+  // add add_symmetry_breaking_clauses to every formula, ignored when
+  // forbidden_directions is not empty since it breaks the symmetries itself
+  bool break_symmetries = false;
+  // directions no edge may leave a node in, by node id, one bit per
+  // direction; the edges added by splits are constrained as well
+  std::unordered_map<int, int> forbidden_directions;
+  // limits of a single solve, 0 for none; a solve that reaches them has no
+  // core to pick from, so corners_per_round edges of the newest cycles are
+  // split
+  long long conflicts_per_solve = 0;
+  double seconds_per_solve = 0.0;
+  // total time of the solves of a drawing, 0 for no limit; every solve is cut
+  // to what is left of it, and DrawingBudgetExhausted is thrown once it is
+  // used up
+  double seconds_per_drawing = 0.0;
+};
+
+// whether the shapes are built by an IncrementalShapeBuilder, throws if
+// incremental is combined with minimize_bends
+bool uses_incremental_builder(const ShapeOptions& options);
+
+// whether solves that took solve_time seconds used up seconds_per_drawing
+bool is_drawing_budget_exhausted(const ShapeOptions& options,
+                                 double solve_time);
+
+// thrown by the shape builders, and so by the make_orthogonal_drawing
+// functions, when seconds_per_drawing is used up before a shape is found;
+// there is no drawing to return, callers that set the budget must catch it
+class DrawingBudgetExhausted : public std::runtime_error {
+ public:
+  DrawingBudgetExhausted()
+      : std::runtime_error("build_shape: SAT budget of the drawing exhausted") {
+  }
+};
+
+// sat_stats, if given, is increased by what was sent to the solvers;
+// initial_phases, if given, is a previous shape of the graph whose directions
+// the solvers try first, also for the edges split since then; throws
+// DrawingBudgetExhausted
 Shape build_shape(Graph& graph, GraphAttributes& attributes,
                   std::vector<std::vector<int>>& cycles,
-                  bool randomize = false);
+                  const ShapeOptions& options = {},
+                  SatStats* sat_stats = nullptr,
+                  const Shape* initial_phases = nullptr);
+
+// Node and cycle constraints are guarded by a selector variable that is passed
+// as an assumption, so that splitting an edge only retires the selectors of
+// the two endpoints and of the cycles through the edge and adds the clauses of
+// what changed. The edges to split are chosen among the failed selectors, so
+// the backend must report real UNSAT cores.
+class IncrementalShapeBuilder {
+ private:
+  Graph& m_graph;
+  GraphAttributes& m_attributes;
+  std::vector<std::vector<int>>& m_cycles;
+  std::mt19937 m_random_engine;
+  int m_corners_per_round;
+  double m_seconds_per_solve;
+  double m_seconds_per_drawing;
+  std::unique_ptr<SatSolver> m_solver;
+  VariablesHandler m_handler;
+  // scratch space for the clauses of one node, cycle or edge
+  CnfBuilder m_cnf_builder;
+  std::unordered_map<int, int> m_node_to_selector;
+  std::unordered_map<int, int> m_selector_to_node;
+  std::vector<int> m_cycle_to_selector;
+  std::unordered_map<int, int> m_selector_to_cycle;
+  // the directions the solver tries first, kept up to date with the splits
+  std::optional<Shape> m_last_shape;
+  // node whose symmetry-breaking clauses share its selector, they are added
+  // again for its new edges whenever one of them is split
+  std::optional<int> m_symmetry_node;
+  // like the symmetry-breaking clauses, they share the node's selector
+  std::unordered_map<int, int> m_forbidden_directions;
+  void add_node_clauses(int node_id);
+  void add_cycle_clauses(int cycle_index);
+  void add_new_definitions();
+  void retire_selector(int selector);
+  void split_edge(int from_id, int to_id);
+  std::vector<std::pair<int, int>> choose_edges_to_split(
+      const std::vector<int>& failed_selectors);
+  std::vector<int> get_assumptions() const;
+
+ public:
+  IncrementalShapeBuilder(Graph& graph, GraphAttributes& attributes,
+                          std::vector<std::vector<int>>& cycles,
+                          const ShapeOptions& options);
+  // both throw DrawingBudgetExhausted
+  std::optional<Shape> build_shape_or_add_corner();
+  Shape build_shape();
+  // replaces the directions the solver tries first, until the next model
+  void set_phases(const Shape& shape);
+  // the solver is kept alive, so a new cycle only costs its own clauses and
+  // the next build_shape starts from the previous model
+  void add_cycle(const std::vector<int>& cycle);
+  const SatStats& get_sat_stats() const { return m_solver->get_stats(); }
+};
 
-#endif
\ No newline at end of file
+#endif
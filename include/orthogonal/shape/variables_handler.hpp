@@ -1,7 +1,9 @@
 #ifndef MY_VARIABLES_HANDLER_H
 #define MY_VARIABLES_HANDLER_H
 
+#include <array>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -9,8 +11,25 @@
 #include "core/graph/graph.hpp"
 #include "orthogonal/shape/shape.hpp"
 
+enum class DirectionEncoding {
+  ONE_HOT,  // one variable per direction, exactly one of them is true
+  COMPACT,  // an "is horizontal" bit and a "positive direction" bit
+};
+
+const std::string direction_encoding_to_string(
+    const DirectionEncoding encoding);
+
+DirectionEncoding string_to_direction_encoding(const std::string& encoding);
+
+// clause that defines an auxiliary literal of the compact encoding
+struct DirectionDefinition {
+  std::pair<int, int> edge;
+  std::vector<int> clause;
+};
+
 class VariablesHandler {
  private:
+  DirectionEncoding m_encoding;
   int m_next_var = 1;  // 0 is reserved for the empty clause
   std::unordered_map<int, std::pair<int, int>> variable_to_edge;
   std::unordered_map<int, Direction> variable_to_direction;
@@ -19,19 +38,42 @@ class VariablesHandler {
   GraphEdgeHashMap<int> m_edge_down_variable;
   GraphEdgeHashMap<int> m_edge_right_variable;
   GraphEdgeHashMap<int> m_edge_left_variable;
+  // compact encoding, the positive literal of (j, i) is the negation of the
+  // one of (i, j)
+  GraphEdgeHashMap<int> m_edge_horizontal_variable;
+  GraphEdgeHashMap<int> m_edge_positive_literal;
+  // literals implying a direction of the compact encoding, created when a
+  // constraint first needs them
+  GraphEdgeHashMap<std::array<int, 4>> m_edge_direction_literals;
+  std::vector<DirectionDefinition> m_new_definitions;
   void add_variable(int i, int j, Direction direction);
-  void add_edge_variables(int i, int j);
+  void add_compact_variables(int i, int j);
 
  public:
-  VariablesHandler(const Graph& graph);
+  VariablesHandler(const Graph& graph,
+                   DirectionEncoding encoding = DirectionEncoding::ONE_HOT);
+  DirectionEncoding get_encoding() const { return m_encoding; }
+  void add_edge_variables(int i, int j);
+  // variable not tied to any edge (e.g. to enable or disable clauses)
+  int add_auxiliary_variable();
   int get_up_variable(int i, int j) const;
   int get_down_variable(int i, int j) const;
   int get_left_variable(int i, int j) const;
   int get_right_variable(int i, int j) const;
   int get_variable(int i, int j, Direction direction) const;
+  // literals whose conjunction means that (i, j) is in the direction
+  std::vector<int> get_direction_literals(int i, int j,
+                                          Direction direction) const;
+  // a single literal that implies that (i, j) is in the direction, with the
+  // compact encoding its definition is queued for take_new_definitions
+  int get_direction_literal(int i, int j, Direction direction);
+  // the caller must add these clauses without any selector, since the
+  // literals they define can be shared by several constraints
+  std::vector<DirectionDefinition> take_new_definitions();
   const std::pair<int, int>& get_edge_of_variable(int variable) const;
   void set_variable_value(int variable, bool value);
   bool get_variable_value(int variable) const;
+  void reset_variables_values();
   Direction get_direction_of_edge(int i, int j) const;
 };
 
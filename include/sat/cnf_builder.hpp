@@ -1,32 +1,42 @@
 #ifndef MY_CNF_BUILDER_H
 #define MY_CNF_BUILDER_H
 
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
-enum class CnfRowType {
-  CLAUSE,
-  COMMENT,
-};
-
-struct CnfRow {
-  CnfRowType m_type;
-  std::vector<int> m_clause;
-  std::string m_comment;
-};
-
+// all the literals live in one buffer, clause i is the range
+// [m_clause_offsets[i], m_clause_offsets[i + 1]), so adding a clause does not
+// allocate once the buffers have grown, and clear() keeps their capacity
 class CnfBuilder {
  private:
   int m_num_vars = 0;
-  int m_num_clauses = 0;
-  std::vector<CnfRow> m_rows;
+  std::vector<int> m_literals;
+  std::vector<size_t> m_clause_offsets = {0};
+  // comment and number of clauses written before it, kept only if enabled
+  std::vector<std::pair<int, std::string>> m_comments;
+  bool m_keep_comments;
 
  public:
-  void add_clause(std::vector<int> clause);
+  explicit CnfBuilder(bool keep_comments = false)
+      : m_keep_comments(keep_comments) {}
+  void add_clause(std::span<const int> clause);
+  void add_clause(std::initializer_list<int> clause) {
+    add_clause(std::span<const int>(clause.begin(), clause.size()));
+  }
   void add_comment(const std::string& comment);
   int get_number_of_variables() const;
   int get_number_of_clauses() const;
+  std::span<const int> get_clause(int index) const;
+  void for_each_clause(
+      const std::function<void(std::span<const int>)>& function) const;
+  void clear();
+  void write_dimacs(std::ostream& stream) const;
   void convert_to_cnf(const std::string& file_path) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,20 +1,35 @@
 #ifndef MY_GLUCOSE_H
 #define MY_GLUCOSE_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 
-enum class GlucoseResultType { SAT, UNSAT };
+#include "sat/cnf_builder.hpp"
+
+// UNKNOWN when the solve was interrupted before an answer was found
+enum class GlucoseResultType { SAT, UNSAT, UNKNOWN };
 
 struct GlucoseResult {
   GlucoseResultType result;
   std::vector<int> numbers;
   std::vector<std::string> proof_lines;
+  // subset of the assumptions responsible for an UNSAT answer
+  std::vector<int> failed_assumptions;
+  // conflicts the solver went through to find the answer, launch_glucose
+  // reads them from the statistics ./glucose prints
+  long long conflicts = 0;
   std::string to_string() const;
   void print() const;
 };
 
-GlucoseResult launch_glucose(const std::string& conjunctive_normal_form_file,
-                             bool randomize = true);
+// spawns ./glucose without a shell, the cnf is streamed to its stdin and the
+// model and the proof are read back from pipes, no temporary files are used;
+// the process is killed and UNKNOWN returned once *interrupted becomes true;
+// a nonzero random_seed randomizes the search, the same seed gives the same
+// search
+GlucoseResult launch_glucose(const CnfBuilder& cnf_builder,
+                             unsigned random_seed = 0, bool with_proof = true,
+                             const std::atomic<bool>* interrupted = nullptr);
 
 #endif
\ No newline at end of file
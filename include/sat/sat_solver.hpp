@@ -0,0 +1,235 @@
+#ifndef MY_SAT_SOLVER_H
+#define MY_SAT_SOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sat/cnf_builder.hpp"
+#include "sat/glucose.hpp"
+
+enum class SatBackend {
+  GLUCOSE_PROCESS,  // runs the ./glucose binary on a temporary cnf file
+  GLUCOSE_LIBRARY,  // runs glucose in-process, linked as a library
+  GLUCOSE_POOL,     // sends the cnf to a long-lived ./sat_worker process
+};
+
+#ifdef USE_GLUCOSE_LIBRARY
+constexpr SatBackend DEFAULT_SAT_BACKEND = SatBackend::GLUCOSE_LIBRARY;
+#else
+constexpr SatBackend DEFAULT_SAT_BACKEND = SatBackend::GLUCOSE_PROCESS;
+#endif
+
+const std::string sat_backend_to_string(const SatBackend backend);
+
+SatBackend string_to_sat_backend(const std::string& backend);
+
+// what was given to the solvers, summed over all the solver instances used
+struct SatStats {
+  int number_of_solves = 0;
+  long long number_of_variables = 0;
+  long long number_of_clauses = 0;
+  // as reported by the backends, the winners' only for a portfolio
+  long long number_of_conflicts = 0;
+  // solves that ran out of budget (or were interrupted) without an answer
+  int number_of_unknown_results = 0;
+  // fewest-corners searches stopped by an UNKNOWN or by the budget, their
+  // shapes may have more corners than needed
+  int number_of_unproven_optima = 0;
+  double solve_time = 0.0;  // seconds
+  void add(const SatStats& other);
+};
+
+// clauses are kept between calls to solve, so the same solver can be reused
+// while the formula grows; assumptions only hold for a single call
+class SatSolver {
+ private:
+  SatStats m_stats;
+  double m_time_budget = 0.0;
+  std::optional<std::chrono::steady_clock::time_point> m_deadline;
+
+ protected:
+  // when the running solve runs out of its time budget, if it has one
+  std::optional<std::chrono::steady_clock::time_point> get_deadline() const {
+    return m_deadline;
+  }
+  virtual void add_clause_to_solver(std::span<const int> clause) = 0;
+  virtual GlucoseResult solve_with_assumptions(
+      const std::vector<int>& assumptions) = 0;
+
+ public:
+  virtual ~SatSolver() = default;
+  void add_clause(std::span<const int> clause);
+  void add_clause(std::initializer_list<int> clause) {
+    add_clause(std::span<const int>(clause.begin(), clause.size()));
+  }
+  void add_clauses(const CnfBuilder& cnf_builder);
+  GlucoseResult solve(const std::vector<int>& assumptions = {});
+  const SatStats& get_stats() const { return m_stats; }
+  // every following solve is interrupted after that many seconds and returns
+  // UNKNOWN, 0 for no limit
+  void set_time_budget(double seconds) { m_time_budget = seconds; }
+  // like set_time_budget but counted in conflicts, ignored by backends that
+  // cannot limit them
+  virtual void set_conflict_budget(long long) {}
+  // preferred value of each literal's variable when the solver branches on it,
+  // ignored by backends that cannot use it
+  virtual void set_phase_hints(const std::vector<int>&) {}
+  // makes the branching heuristic random, instances with different seeds
+  // explore the search space in a different order
+  virtual void set_random_seed(unsigned) {}
+  // can be called from another thread, the running solve (or the next one, if
+  // none is running) returns UNKNOWN as soon as possible, until
+  // clear_interrupt is called
+  virtual void interrupt() {}
+  virtual void clear_interrupt() {}
+};
+
+// every call to solve streams the whole formula to a new ./glucose process,
+// assumptions are added as unit clauses and all of them are reported as
+// failed on UNSAT; phase hints are ignored, ./glucose has no way to read them
+class GlucoseProcessSolver : public SatSolver {
+ private:
+  CnfBuilder m_cnf_builder;
+  bool m_with_proof;
+  unsigned m_random_seed = 0;
+  std::atomic<bool> m_interrupted = false;
+
+ public:
+  GlucoseProcessSolver(bool with_proof) : m_with_proof(with_proof) {}
+  // passed to the binary as -rnd-seed
+  void set_random_seed(unsigned seed) override { m_random_seed = seed; }
+  void interrupt() override { m_interrupted = true; }
+  void clear_interrupt() override { m_interrupted = false; }
+
+ protected:
+  void add_clause_to_solver(std::span<const int> clause) override;
+  GlucoseResult solve_with_assumptions(
+      const std::vector<int>& assumptions) override;
+};
+
+class SatWorker;
+
+// like GlucoseProcessSolver, but every call to solve borrows a worker from
+// get_sat_worker_pool() instead of starting a new process, cores are real;
+// the worker of the previous solve is borrowed again when idle and then
+// keeps its solver, otherwise the whole formula is sent to a new solver and
+// what was learned is lost; an interrupt kills the borrowed worker, which
+// the pool then replaces; a solve that waits for a worker past its time
+// budget or an interrupt returns UNKNOWN
+class GlucosePoolSolver : public SatSolver {
+ private:
+  // tells the workers which formula they hold
+  const unsigned long long m_id;
+  CnfBuilder m_cnf_builder;
+  bool m_with_proof;
+  unsigned m_random_seed = 0;
+  long long m_conflict_budget = 0;
+  std::vector<int> m_phase_hints;
+  // guards the worker of the running solve against a concurrent interrupt
+  std::mutex m_worker_mutex;
+  SatWorker* m_worker = nullptr;
+  // also read by the pool while the solve waits for a worker
+  std::atomic<bool> m_interrupted = false;
+
+ public:
+  GlucosePoolSolver(bool with_proof);
+  // used only when a worker starts a new solver
+  void set_random_seed(unsigned seed) override { m_random_seed = seed; }
+  void set_conflict_budget(long long conflicts) override {
+    m_conflict_budget = conflicts;
+  }
+  // sent with every job, a kept solver also keeps the previous hints of the
+  // variables not in literals
+  void set_phase_hints(const std::vector<int>& literals) override {
+    m_phase_hints = literals;
+  }
+  void interrupt() override;
+  void clear_interrupt() override;
+
+ protected:
+  void add_clause_to_solver(std::span<const int> clause) override;
+  GlucoseResult solve_with_assumptions(
+      const std::vector<int>& assumptions) override;
+};
+
+class GlucoseLibrarySolverImpl;
+
+// one live glucose instance, learned clauses survive between calls
+class GlucoseLibrarySolver : public SatSolver {
+ private:
+  std::unique_ptr<GlucoseLibrarySolverImpl> m_impl;
+
+ public:
+  GlucoseLibrarySolver(bool with_proof);
+
+ protected:
+  void add_clause_to_solver(std::span<const int> clause) override;
+  GlucoseResult solve_with_assumptions(
+      const std::vector<int>& assumptions) override;
+
+ public:
+  void set_phase_hints(const std::vector<int>& literals) override;
+  void set_random_seed(unsigned seed) override;
+  void set_conflict_budget(long long conflicts) override;
+  void interrupt() override;
+  void clear_interrupt() override;
+  ~GlucoseLibrarySolver();
+};
+
+// Runs differently seeded copies of the same formula in parallel, one thread
+// each, and returns the first answer, the other solves are interrupted. The
+// core or the proof of an UNSAT answer are the ones of the winner. The
+// threads live as long as the portfolio and wait for the next solve.
+class PortfolioSolver : public SatSolver {
+ private:
+  std::vector<std::unique_ptr<SatSolver>> m_solvers;
+  std::vector<std::thread> m_threads;
+  // guards the state of the running solve below
+  std::mutex m_mutex;
+  std::condition_variable m_solve_started;
+  std::condition_variable m_solve_finished;
+  long long m_solve_index = 0;
+  int m_running_solvers = 0;
+  bool m_stopping = false;
+  const std::vector<int>* m_assumptions = nullptr;
+  std::optional<GlucoseResult> m_winner;
+  std::exception_ptr m_error;
+  void run_solver(int index);
+
+ public:
+  PortfolioSolver(std::vector<std::unique_ptr<SatSolver>> solvers);
+  ~PortfolioSolver();
+  PortfolioSolver(const PortfolioSolver&) = delete;
+  PortfolioSolver& operator=(const PortfolioSolver&) = delete;
+  void set_phase_hints(const std::vector<int>& literals) override;
+  void set_conflict_budget(long long conflicts) override;
+  void interrupt() override;
+  void clear_interrupt() override;
+
+ protected:
+  void add_clause_to_solver(std::span<const int> clause) override;
+  GlucoseResult solve_with_assumptions(
+      const std::vector<int>& assumptions) override;
+};
+
+// whether failed_assumptions is a real UNSAT core rather than all assumptions
+bool reports_failed_assumptions(const SatBackend backend);
+
+// the proof is needed only when the caller reads unit clauses from it; with
+// portfolio_size > 1 a PortfolioSolver of that many instances is returned,
+// the first one unseeded and the others seeded 1, 2, ...
+std::unique_ptr<SatSolver> make_sat_solver(const SatBackend backend,
+                                           bool with_proof = true,
+                                           int portfolio_size = 1);
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef MY_SAT_WORKER_POOL_H
+#define MY_SAT_WORKER_POOL_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "sat/cnf_builder.hpp"
+#include "sat/glucose.hpp"
+
+// Protocol between SatWorker and the ./sat_worker process, one text line per
+// message, a job is
+//   j <with_proof> <random seed, 0 for none> <conflict budget, 0 for none>
+//     (starts a new solver) or u <conflict budget> (keeps the solver of the
+//     previous job, only the clauses added since then follow)
+//   p <phase hints> 0   (optional)
+//   <clause> 0          (any number of clauses)
+//   a <assumptions> 0   (starts the solve)
+// and the answer is
+//   s SATISFIABLE / s UNSATISFIABLE / s UNKNOWN
+//   v <model> 0         (SAT) or f <failed assumptions> 0 (UNSAT)
+//   r <proof line>      (UNSAT with proof, any number)
+//   c <conflicts>
+//   e
+
+// a long-lived ./sat_worker process, it solves one job at a time
+class SatWorker {
+ private:
+  pid_t m_pid;
+  FILE* m_to_worker;
+  FILE* m_from_worker;
+  bool m_broken = false;
+  std::atomic<bool> m_killed = false;
+  // whose formula the worker's solver holds, 0 for nobody, and how many of
+  // its clauses were sent
+  unsigned long long m_owner = 0;
+  int m_sent_clauses = 0;
+
+ public:
+  SatWorker();
+  // when the previous job came from the same owner, a nonzero id, its solver
+  // is kept and only the clauses of cnf_builder not sent yet are streamed,
+  // so the learned clauses survive; with_proof and random_seed are then
+  // the ones of that job
+  GlucoseResult solve(unsigned long long owner, const CnfBuilder& cnf_builder,
+                      const std::vector<int>& assumptions, bool with_proof,
+                      unsigned random_seed = 0,
+                      long long conflict_budget = 0,
+                      const std::vector<int>& phase_hints = {});
+  // can be called from another thread, the running solve then throws
+  void kill();
+  bool is_broken() const { return m_broken || m_killed; }
+  unsigned long long get_owner() const { return m_owner; }
+  ~SatWorker();
+  SatWorker(const SatWorker&) = delete;
+  SatWorker& operator=(const SatWorker&) = delete;
+};
+
+class SatWorkerPool;
+
+// gives the worker back to the pool when destroyed, holds none when the
+// borrow gave up
+class SatWorkerLease {
+ private:
+  SatWorkerPool& m_pool;
+  SatWorker* m_worker;
+
+ public:
+  SatWorkerLease(SatWorkerPool& pool, SatWorker* worker)
+      : m_pool(pool), m_worker(worker) {}
+  SatWorker* operator->() const { return m_worker; }
+  SatWorker* get() const { return m_worker; }
+  ~SatWorkerLease();
+  SatWorkerLease(const SatWorkerLease&) = delete;
+  SatWorkerLease& operator=(const SatWorkerLease&) = delete;
+};
+
+// workers are spawned on demand up to max_workers and then reused, a thread
+// that finds all of them busy waits for one to be released; an idle worker
+// that still holds the owner's formula is preferred
+class SatWorkerPool {
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_worker_released;
+  std::vector<std::unique_ptr<SatWorker>> m_workers;
+  std::vector<SatWorker*> m_idle_workers;
+  const int m_max_workers;
+
+ public:
+  SatWorkerPool(int max_workers) : m_max_workers(max_workers) {}
+  // gives up and returns an empty lease once cancelled is set or the
+  // deadline passes
+  SatWorkerLease borrow(
+      unsigned long long owner = 0,
+      const std::atomic<bool>* cancelled = nullptr,
+      std::optional<std::chrono::steady_clock::time_point> deadline =
+          std::nullopt);
+  void release(SatWorker* worker);
+  // makes the waiting borrows check their cancelled flag again
+  void wake_waiting();
+};
+
+// one worker per hardware thread, created on first use
+SatWorkerPool& get_sat_worker_pool();
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef MY_SOLVER_PROCESS_H
+#define MY_SOLVER_PROCESS_H
+
+#include <signal.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+// the pipe is close-on-exec, so it does not leak into processes spawned by
+// other threads
+void make_pipe(int fds[2]);
+
+void close_if_open(int& fd);
+
+// spawns arguments[0] without a shell, with stdin and stdout redirected to the
+// given descriptors and stderr to /dev/null; extra_fd, if not -1, becomes
+// descriptor 3 of the child
+pid_t spawn_solver_process(const std::vector<std::string>& arguments,
+                           int input_fd, int output_fd, int extra_fd = -1);
+
+// throws if the child was killed or exited with a code not in exit_codes
+int wait_solver_process(pid_t pid, const std::vector<int>& exit_codes);
+
+// writing to a pipe whose reader died must fail with EPIPE instead of killing
+// the whole program, SIGPIPE is blocked for the calling thread meanwhile
+class SigpipeBlocker {
+ private:
+  sigset_t m_old_mask;
+
+ public:
+  SigpipeBlocker();
+  ~SigpipeBlocker();
+  SigpipeBlocker(const SigpipeBlocker&) = delete;
+  SigpipeBlocker& operator=(const SigpipeBlocker&) = delete;
+};
+
+#endif
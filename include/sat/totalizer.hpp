@@ -0,0 +1,17 @@
+#ifndef MY_TOTALIZER_H
+#define MY_TOTALIZER_H
+
+#include <functional>
+#include <vector>
+
+#include "sat/sat_solver.hpp"
+
+// Totalizer cardinality encoding (Bailleux and Boufkhad), only the clauses
+// that push the count up are added. outputs[k] is implied when at least
+// k + 1 of the inputs are true, and only the first `limit` outputs are built,
+// so assuming -outputs[k] with k < limit forces the sum to be at most k.
+std::vector<int> add_totalizer(SatSolver& solver,
+                               const std::vector<int>& inputs, int limit,
+                               const std::function<int()>& new_variable);
+
+#endif
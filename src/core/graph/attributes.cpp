@@ -12,7 +12,7 @@ void GraphAttributes::add_attribute(Attribute attribute) {
 }
 
 void GraphAttributes::remove_nodes_attribute(int node_id) {
-  for (auto [attribute, nodes_attributes] : mattribute_to_node) {
+  for (auto& [attribute, nodes_attributes] : mattribute_to_node) {
     nodes_attributes.erase(node_id);
   }
 }
@@ -5,6 +5,8 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "core/graph/graph_builder.hpp"
+
 std::unique_ptr<Graph> load_graph_from_txt_file(const std::string& filename) {
   auto graph = std::make_unique<Graph>();
   load_graph_from_txt_file(filename, *graph);
@@ -16,6 +18,7 @@ void load_graph_from_txt_file(const std::string& filename, Graph& graph) {
     throw std::runtime_error("Graph is not empty. Please use a new graph.");
   std::ifstream infile(filename);
   if (!infile) throw std::runtime_error("Could not open file: " + filename);
+  GraphBuilder builder;
   std::string line;
   enum Section { NONE, NODES, EDGES } section = NONE;
   while (std::getline(infile, line)) {
@@ -27,14 +30,15 @@ void load_graph_from_txt_file(const std::string& filename, Graph& graph) {
       std::istringstream iss(line);
       if (section == NODES) {
         int node_id;
-        if (iss >> node_id) graph.add_node(node_id);
+        if (iss >> node_id) builder.add_node(node_id);
       } else if (section == EDGES) {
         int from, to;
-        if (iss >> from >> to) graph.add_edge(from, to);
+        if (iss >> from >> to) builder.add_edge(from, to);
       }
     }
   }
   infile.close();
+  builder.finalize(graph);
 }
 
 std::unique_ptr<Graph> load_undirected_graph_from_gml_file(
@@ -0,0 +1,65 @@
+#include "core/graph/frozen_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// the ids are indexed by a vector while the largest one is less than this
+// many times the nodes (plus a few)
+constexpr long long DENSE_IDS_PER_NODE = 4;
+constexpr long long MIN_DENSE_IDS = 64;
+
+void FrozenGraph::build_id_index() {
+  int max_id = -1;
+  for (int id : m_index_to_id) max_id = std::max(max_id, id);
+  if (max_id < DENSE_IDS_PER_NODE * size() + MIN_DENSE_IDS) {
+    m_id_to_index.assign((size_t)max_id + 1, -1);
+    for (int index = 0; index < size(); ++index)
+      m_id_to_index[m_index_to_id[index]] = index;
+    return;
+  }
+  m_sparse_id_to_index.reserve(size());
+  for (int index = 0; index < size(); ++index)
+    m_sparse_id_to_index[m_index_to_id[index]] = index;
+}
+
+FrozenGraph::FrozenGraph(const Graph& graph) {
+  m_index_to_id.reserve(graph.size());
+  for (int id : graph.get_nodes_ids()) m_index_to_id.push_back(id);
+  build_id_index();
+  m_offsets.reserve(size() + 1);
+  m_targets.reserve(graph.get_number_of_edges());
+  m_offsets.push_back(0);
+  for (int index = 0; index < size(); ++index) {
+    for (auto& edge : graph.get_edges_of_node(m_index_to_id[index]))
+      m_targets.push_back(find_index(edge.get_to().get_id()));
+    m_offsets.push_back(m_targets.size());
+  }
+}
+
+int FrozenGraph::get_index(int id) const {
+  if (!has_node(id))
+    throw std::runtime_error("FrozenGraph::get_index: node not found");
+  return find_index(id);
+}
+
+bool FrozenGraph::has_edge(int from_index, int to_index) const {
+  auto neighbors = get_neighbors(from_index);
+  return std::find(neighbors.begin(), neighbors.end(), to_index) !=
+         neighbors.end();
+}
+
+FrozenGraph::FrozenGraph(const std::vector<int>& node_ids,
+                         const std::vector<std::pair<int, int>>& edges)
+    : m_index_to_id(node_ids) {
+  build_id_index();
+  // counting sort of the edges by source, stable so that every node keeps the
+  // order its edges were given in
+  m_offsets.assign(size() + 1, 0);
+  for (auto [from_id, to_id] : edges) ++m_offsets[find_index(from_id) + 1];
+  for (int index = 0; index < size(); ++index)
+    m_offsets[index + 1] += m_offsets[index];
+  m_targets.resize(edges.size());
+  std::vector<int> next(m_offsets.begin(), m_offsets.end() - 1);
+  for (auto [from_id, to_id] : edges)
+    m_targets[next[find_index(from_id)]++] = find_index(to_id);
+}
@@ -6,16 +6,23 @@
 
 GraphEdge::GraphEdge(int id, const GraphNode& from, const GraphNode& to,
                      const Graph& owner)
-    : m_id(id), m_from(from), m_to(to), m_graph_owner(owner) {
+    : m_id(id),
+      m_from_id(from.get_id()),
+      m_to_id(to.get_id()),
+      m_graph_owner(owner.m_owner_cell.get()) {
   if (&from.get_owner() != &owner || &to.get_owner() != &owner)
     throw std::runtime_error(
         "GraphEdge constructor: nodes do not belong to the same graph");
 }
 
 const std::string GraphEdge::to_string() const {
-  return "Edge[" + m_from.to_string() + " -> " + m_to.to_string() + "]";
+  return "Edge[" + get_from().to_string() + " -> " + get_to().to_string() +
+         "]";
 }
 
+GraphNode::GraphNode(int id, const Graph& owner)
+    : m_id(id), m_graph_owner(owner.m_owner_cell.get()) {}
+
 std::string GraphNode::to_string() const {
   std::string result = "Node " + std::to_string(m_id) + " neighbors:";
   for (const auto& edge : get_edges())
@@ -23,24 +30,134 @@ std::string GraphNode::to_string() const {
   return result;
 }
 
+int Graph::find_incidence(const SmallVector<Incidence, 4>& incidences,
+                          int neighbor_id) {
+  for (int k = 0; k < incidences.size(); ++k)
+    if (incidences[k].neighbor_id == neighbor_id) return k;
+  return -1;
+}
+
 const GraphNode& Graph::add_node(int id) {
   if (id < 0)
     throw std::runtime_error("Graph::add_node: id must be non-negative");
   if (has_node(id))
     throw std::runtime_error(
         "Graph::add_node: node with this id already exists");
-  GraphNode* node = new GraphNode(id, *this);
-  m_nodeid_to_node_map[id] = std::unique_ptr<GraphNode>(node);
-  m_nodeid_to_edgesid[id] = std::unordered_set<int>();
-  m_nodeid_to_neighborsid_to_edgesid[id] = std::unordered_map<int, int>();
-  m_nodeid_to_incoming_edgesid_map[id] = std::unordered_set<int>();
-  return *node;
+  return add_node_unchecked(id);
+}
+
+// an id goes in the vector while it is less than this many times the nodes
+// (plus a few), so a single large id cannot allocate memory for all the
+// smaller ones
+constexpr long long DENSE_IDS_PER_NODE = 4;
+constexpr long long MIN_DENSE_IDS = 64;
+
+const GraphNode& Graph::add_node_unchecked(int id) {
+  bool is_dense =
+      id < (long long)m_nodeid_to_slot.size() ||
+      id < DENSE_IDS_PER_NODE * (long long)m_node_order.size() + MIN_DENSE_IDS;
+  if (is_dense && id >= (long long)m_nodeid_to_slot.size())
+    m_nodeid_to_slot.resize((size_t)id + 1, -1);
+  int slot;
+  if (!m_free_node_slots.empty()) {
+    slot = m_free_node_slots.back();
+    m_free_node_slots.pop_back();
+    m_node_slots[slot].node = GraphNode(id, *this);
+  } else {
+    slot = m_node_slots.size();
+    std::pmr::memory_resource* resource = get_memory_resource();
+    m_node_slots.push_back({GraphNode(id, *this),
+                            SmallVector<Incidence, 4>(resource),
+                            SmallVector<Incidence, 4>(resource), 0});
+  }
+  m_node_slots[slot].position = m_node_order.size();
+  m_node_order.push_back(slot);
+  if (is_dense)
+    m_nodeid_to_slot[id] = slot;
+  else
+    m_sparse_nodeid_to_slot[id] = slot;
+  return m_node_slots[slot].node;
+}
+
+Graph::Graph(Graph&& other)
+    : m_owner_cell(std::move(other.m_owner_cell)),
+      m_next_node_id(other.m_next_node_id),
+      m_nodeid_to_slot(std::move(other.m_nodeid_to_slot)),
+      m_sparse_nodeid_to_slot(std::move(other.m_sparse_nodeid_to_slot)),
+      m_node_slots(std::move(other.m_node_slots)),
+      m_free_node_slots(std::move(other.m_free_node_slots)),
+      m_node_order(std::move(other.m_node_order)),
+      m_edge_slots(std::move(other.m_edge_slots)),
+      m_free_edge_ids(std::move(other.m_free_edge_ids)),
+      m_edge_order(std::move(other.m_edge_order)) {
+  *m_owner_cell = this;
+  other.m_owner_cell = std::make_unique<const Graph*>(&other);
+  other.clear();
+}
+
+Graph& Graph::operator=(Graph&& other) {
+  if (this == &other) return *this;
+  // the incidences spilled by the slots would stay in the resource of other,
+  // they are copied to this one and the copy is moved in instead
+  if (get_memory_resource() != other.get_memory_resource()) {
+    *this = other.clone(get_memory_resource());
+    other.clear();
+    return *this;
+  }
+  m_next_node_id = other.m_next_node_id;
+  m_nodeid_to_slot = std::move(other.m_nodeid_to_slot);
+  m_sparse_nodeid_to_slot = std::move(other.m_sparse_nodeid_to_slot);
+  m_node_slots = std::move(other.m_node_slots);
+  m_free_node_slots = std::move(other.m_free_node_slots);
+  m_node_order = std::move(other.m_node_order);
+  m_edge_slots = std::move(other.m_edge_slots);
+  m_free_edge_ids = std::move(other.m_free_edge_ids);
+  m_edge_order = std::move(other.m_edge_order);
+  std::swap(m_owner_cell, other.m_owner_cell);
+  *m_owner_cell = this;
+  *other.m_owner_cell = &other;
+  other.clear();
+  return *this;
 }
 
-int Graph::get_number_of_edges() const {
-  int count = 0;
-  for (const auto& node : get_nodes()) count += node.get_degree();
-  return count;
+void Graph::clear() {
+  m_next_node_id = 0;
+  m_nodeid_to_slot.clear();
+  m_sparse_nodeid_to_slot.clear();
+  m_node_slots.clear();
+  m_free_node_slots.clear();
+  m_node_order.clear();
+  m_edge_slots.clear();
+  m_free_edge_ids.clear();
+  m_edge_order.clear();
+}
+
+Graph Graph::clone(std::pmr::memory_resource* resource) const {
+  Graph graph(resource);
+  graph.m_next_node_id = m_next_node_id;
+  graph.m_nodeid_to_slot.assign(m_nodeid_to_slot.begin(),
+                                m_nodeid_to_slot.end());
+  graph.m_sparse_nodeid_to_slot.insert(m_sparse_nodeid_to_slot.begin(),
+                                       m_sparse_nodeid_to_slot.end());
+  for (const auto& slot : m_node_slots)
+    graph.m_node_slots.push_back(
+        {slot.node, SmallVector<Incidence, 4>(slot.out_edges, resource),
+         SmallVector<Incidence, 4>(slot.in_edges, resource), slot.position});
+  graph.m_free_node_slots.assign(m_free_node_slots.begin(),
+                                 m_free_node_slots.end());
+  graph.m_node_order.assign(m_node_order.begin(), m_node_order.end());
+  graph.m_edge_slots.assign(m_edge_slots.begin(), m_edge_slots.end());
+  graph.m_free_edge_ids.assign(m_free_edge_ids.begin(), m_free_edge_ids.end());
+  graph.m_edge_order.assign(m_edge_order.begin(), m_edge_order.end());
+  const Graph* const* owner_cell = graph.m_owner_cell.get();
+  for (auto& slot : graph.m_node_slots) slot.node.m_graph_owner = owner_cell;
+  for (auto& slot : graph.m_edge_slots) slot.edge.m_graph_owner = owner_cell;
+  return graph;
+}
+
+void Graph::reserve(int number_of_nodes, int number_of_edges) {
+  m_node_order.reserve(number_of_nodes);
+  m_edge_order.reserve(number_of_edges);
 }
 
 const std::string Graph::to_string() const {
@@ -52,7 +169,7 @@ const std::string Graph::to_string() const {
 const GraphNode& Graph::get_node_by_id(int id) const {
   if (!has_node(id))
     throw std::runtime_error("Graph::get_node_by_id: node not found");
-  return *m_nodeid_to_node_map.at(id);
+  return get_slot(id).node;
 }
 
 const GraphNode& Graph::add_node() {
@@ -67,21 +184,32 @@ const GraphEdge& Graph::add_edge(int from_id, int to_id) {
     throw std::runtime_error("Graph::add_edge: edge already exists");
   // if (from_id == to_id)
   //   throw std::runtime_error("Graph::add_edge: cannot add self-loop");
-  auto& from_node = m_nodeid_to_node_map.at(from_id);
-  auto& to_node = m_nodeid_to_node_map.at(to_id);
-  GraphEdge* edge =
-      new GraphEdge(m_next_edge_id++, *from_node, *to_node, *this);
-  m_nodeid_to_edgesid[from_id].insert(edge->get_id());
-  m_nodeid_to_neighborsid_to_edgesid[from_id][to_id] = edge->get_id();
-  m_edgeid_to_edge_map[edge->get_id()] = std::unique_ptr<GraphEdge>(edge);
-  m_nodeid_to_incoming_edgesid_map[to_id].insert(edge->get_id());
-  return *edge;
+  return add_edge_unchecked(from_id, to_id);
+}
+
+const GraphEdge& Graph::add_edge_unchecked(int from_id, int to_id) {
+  const GraphNode& from_node = get_slot(from_id).node;
+  const GraphNode& to_node = get_slot(to_id).node;
+  int edge_id;
+  if (!m_free_edge_ids.empty()) {
+    edge_id = m_free_edge_ids.back();
+    m_free_edge_ids.pop_back();
+    m_edge_slots[edge_id].edge = GraphEdge(edge_id, from_node, to_node, *this);
+  } else {
+    edge_id = m_edge_slots.size();
+    m_edge_slots.push_back({GraphEdge(edge_id, from_node, to_node, *this), 0});
+  }
+  m_edge_slots[edge_id].position = m_edge_order.size();
+  m_edge_order.push_back(edge_id);
+  get_slot(from_id).out_edges.push_back({to_id, edge_id});
+  get_slot(to_id).in_edges.push_back({from_id, edge_id});
+  return m_edge_slots[edge_id].edge;
 }
 
 bool Graph::has_edge(int from_id, int to_id) const {
   if (!has_node(from_id) || !has_node(to_id))
     throw std::runtime_error("Graph::has_edge: node not found");
-  return m_nodeid_to_neighborsid_to_edgesid.at(from_id).contains(to_id);
+  return find_incidence(get_slot(from_id).out_edges, to_id) != -1;
 }
 
 const GraphEdge& Graph::get_edge(int from_id, int to_id) const {
@@ -96,15 +224,17 @@ const GraphEdge& Graph::get_edge(int from_id, int to_id) const {
 int Graph::get_edge_id(int from_id, int to_id) const {
   if (!has_node(from_id) || !has_node(to_id))
     throw std::runtime_error("Graph::get_edge_id: node not found");
-  if (!has_edge(from_id, to_id))
-    throw std::runtime_error("Graph::get_edge_id: edge not found");
-  return m_nodeid_to_neighborsid_to_edgesid.at(from_id).at(to_id);
+  const auto& out_edges = get_slot(from_id).out_edges;
+  int k = find_incidence(out_edges, to_id);
+  if (k == -1) throw std::runtime_error("Graph::get_edge_id: edge not found");
+  return out_edges[k].edge_id;
 }
 
 const GraphEdge& Graph::get_edge_by_id(int edge_id) const {
-  if (!m_edgeid_to_edge_map.contains(edge_id))
+  if (edge_id < 0 || edge_id >= m_edge_slots.size() ||
+      m_edge_slots[edge_id].position == -1)
     throw std::runtime_error("Graph::get_edge: edge not found");
-  return *m_edgeid_to_edge_map.at(edge_id);
+  return m_edge_slots[edge_id].edge;
 }
 
 void Graph::add_undirected_edge(int from_id, int to_id) {
@@ -115,11 +245,19 @@ void Graph::add_undirected_edge(int from_id, int to_id) {
 void Graph::remove_edge(int from_id, int to_id) {
   if (!has_edge(from_id, to_id))
     throw std::runtime_error("Graph::remove_edge: edge not found");
-  int edge_id = get_edge_id(from_id, to_id);
-  m_nodeid_to_edgesid[from_id].erase(edge_id);
-  m_nodeid_to_neighborsid_to_edgesid[from_id].erase(to_id);
-  m_edgeid_to_edge_map.erase(edge_id);
-  m_nodeid_to_incoming_edgesid_map[to_id].erase(edge_id);
+  auto& out_edges = get_slot(from_id).out_edges;
+  int k = find_incidence(out_edges, to_id);
+  int edge_id = out_edges[k].edge_id;
+  out_edges.erase_at(k);
+  auto& in_edges = get_slot(to_id).in_edges;
+  in_edges.erase_at(find_incidence(in_edges, from_id));
+  // the last edge takes the place of the removed one in the order
+  int position = m_edge_slots[edge_id].position;
+  m_edge_order[position] = m_edge_order.back();
+  m_edge_slots[m_edge_order[position]].position = position;
+  m_edge_order.pop_back();
+  m_edge_slots[edge_id].position = -1;
+  m_free_edge_ids.push_back(edge_id);
 }
 
 void Graph::remove_undirected_edge(int from_id, int to_id) {
@@ -130,28 +268,30 @@ void Graph::remove_undirected_edge(int from_id, int to_id) {
 void Graph::remove_node(int id) {
   if (!has_node(id))
     throw std::runtime_error("Graph::remove_node: node not found");
-  std::vector<int> edges_to_remove;
-  for (const auto& edge : get_edges_of_node(id))
-    edges_to_remove.push_back(edge.get_to().get_id());
-  for (int neighbor_id : edges_to_remove) remove_edge(id, neighbor_id);
-  edges_to_remove.clear();
-  for (int edge_id : m_nodeid_to_incoming_edgesid_map[id])
-    edges_to_remove.push_back(get_edge_by_id(edge_id).get_from().get_id());
-  for (int neighbor_id : edges_to_remove) remove_edge(neighbor_id, id);
-  m_nodeid_to_node_map.erase(id);
-  m_nodeid_to_edgesid.erase(id);
-  m_nodeid_to_neighborsid_to_edgesid.erase(id);
-  m_nodeid_to_incoming_edgesid_map.erase(id);
+  while (!get_slot(id).out_edges.empty())
+    remove_edge(id, get_slot(id).out_edges[0].neighbor_id);
+  while (!get_slot(id).in_edges.empty())
+    remove_edge(get_slot(id).in_edges[0].neighbor_id, id);
+  int slot = find_slot(id);
+  int position = m_node_slots[slot].position;
+  m_node_order[position] = m_node_order.back();
+  m_node_slots[m_node_order[position]].position = position;
+  m_node_order.pop_back();
+  if (id < (int)m_nodeid_to_slot.size() && m_nodeid_to_slot[id] == slot)
+    m_nodeid_to_slot[id] = -1;
+  else
+    m_sparse_nodeid_to_slot.erase(id);
+  m_free_node_slots.push_back(slot);
 }
 
 int Graph::get_degree_of_node(int node_id) const {
   if (!has_node(node_id))
     throw std::runtime_error("Graph::get_degree_of_node: node not found");
-  return m_nodeid_to_edgesid.at(node_id).size();
+  return get_slot(node_id).out_edges.size();
 }
 
 int Graph::get_in_degree_of_node(int node_id) const {
   if (!has_node(node_id))
     throw std::runtime_error("Graph::get_in_degree_of_node: node not found");
-  return m_nodeid_to_incoming_edgesid_map.at(node_id).size();
-}
\ No newline at end of file
+  return get_slot(node_id).in_edges.size();
+}
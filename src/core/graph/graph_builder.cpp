@@ -0,0 +1,65 @@
+#include "core/graph/graph_builder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+void GraphBuilder::reserve(int number_of_nodes, int number_of_edges) {
+  m_nodes.reserve(number_of_nodes);
+  m_edges.reserve(number_of_edges);
+}
+
+void GraphBuilder::add_graph(const Graph& graph) {
+  reserve(size() + graph.size(),
+          get_number_of_edges() + graph.get_number_of_edges());
+  for (int id : graph.get_nodes_ids()) add_node(id);
+  for (const auto& node : graph.get_nodes())
+    for (const auto& edge : node.get_edges())
+      add_edge(node.get_id(), edge.get_to().get_id());
+}
+
+void GraphBuilder::validate() const {
+  for (int id : m_nodes)
+    if (id < 0)
+      throw std::runtime_error(
+          "GraphBuilder::finalize: id must be non-negative");
+  // sorted rather than indexed by id, so that large ids cost no memory
+  std::vector<int> sorted_nodes(m_nodes);
+  std::sort(sorted_nodes.begin(), sorted_nodes.end());
+  if (std::adjacent_find(sorted_nodes.begin(), sorted_nodes.end()) !=
+      sorted_nodes.end())
+    throw std::runtime_error(
+        "GraphBuilder::finalize: node with this id already exists");
+  auto has_node = [&](int id) {
+    return std::binary_search(sorted_nodes.begin(), sorted_nodes.end(), id);
+  };
+  for (auto [from_id, to_id] : m_edges)
+    if (!has_node(from_id) || !has_node(to_id))
+      throw std::runtime_error("GraphBuilder::finalize: node not found");
+  std::vector<std::pair<int, int>> sorted_edges(m_edges);
+  std::sort(sorted_edges.begin(), sorted_edges.end());
+  if (std::adjacent_find(sorted_edges.begin(), sorted_edges.end()) !=
+      sorted_edges.end())
+    throw std::runtime_error("GraphBuilder::finalize: edge already exists");
+}
+
+std::unique_ptr<Graph> GraphBuilder::finalize(
+    std::pmr::memory_resource* resource) const {
+  auto graph = std::make_unique<Graph>(resource);
+  finalize(*graph);
+  return graph;
+}
+
+void GraphBuilder::finalize(Graph& graph) const {
+  if (graph.size() > 0)
+    throw std::runtime_error("GraphBuilder::finalize: graph is not empty");
+  validate();
+  graph.reserve(m_nodes.size(), m_edges.size());
+  for (int id : m_nodes) graph.add_node_unchecked(id);
+  for (auto [from_id, to_id] : m_edges)
+    graph.add_edge_unchecked(from_id, to_id);
+}
+
+FrozenGraph GraphBuilder::finalize_frozen() const {
+  validate();
+  return FrozenGraph(m_nodes, m_edges);
+}
@@ -1,33 +1,40 @@
 #include "core/graph/graphs_algorithms.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <functional>
 #include <limits>
-#include <list>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+#include "core/graph/graph_builder.hpp"
 #include "core/tree/tree.hpp"
 #include "core/tree/tree_algorithms.hpp"
 
 bool is_graph_connected(const Graph& graph) {
+  return is_graph_connected(FrozenGraph(graph));
+}
+
+bool is_graph_connected(const FrozenGraph& graph) {
   if (graph.size() == 0) return true;
-  std::unordered_set<int> visited;
-  std::vector<const GraphNode*> stack;
-  stack.push_back(&(*graph.get_nodes().begin()));
+  std::vector<bool> visited(graph.size(), false);
+  std::vector<int> stack{0};
+  visited[0] = true;
+  int number_of_visited = 1;
   while (!stack.empty()) {
-    auto* node = stack.back();
+    int node = stack.back();
     stack.pop_back();
-    visited.insert(node->get_id());
-    for (auto& edge : node->get_edges())
-      if (!visited.contains(edge.get_to().get_id()))
-        stack.push_back(&edge.get_to());
+    for (int neighbor : graph.get_neighbors(node))
+      if (!visited[neighbor]) {
+        visited[neighbor] = true;
+        ++number_of_visited;
+        stack.push_back(neighbor);
+      }
   }
-  for (auto& node : graph.get_nodes())
-    if (!visited.contains(node.get_id())) return false;
-  return true;
+  return number_of_visited == graph.size();
 }
 
 bool is_graph_undirected(const Graph& graph) {
@@ -116,29 +123,278 @@ std::optional<std::vector<int>> find_a_cycle_directed_graph(
   return cycle;
 }
 
+std::vector<std::vector<int>> find_edge_disjoint_cycles_directed_graph(
+    const Graph& graph) {
+  Graph remaining = graph.clone();
+  std::vector<std::vector<int>> cycles;
+  auto cycle = find_a_cycle_directed_graph(remaining);
+  while (cycle.has_value()) {
+    for (int k = 0; k < cycle->size(); k++)
+      remaining.remove_edge((*cycle)[k], (*cycle)[(k + 1) % cycle->size()]);
+    cycles.push_back(std::move(cycle.value()));
+    cycle = find_a_cycle_directed_graph(remaining);
+  }
+  return cycles;
+}
+
 std::vector<std::vector<int>> compute_cycle_basis(const Graph& graph) {
-  auto spanning = build_spanning_tree(graph);
+  return compute_cycle_basis(FrozenGraph(graph));
+}
+
+std::vector<std::vector<int>> compute_cycle_basis(const FrozenGraph& graph) {
+  return compute_flat_cycle_basis(graph).to_vectors();
+}
+
+int FlatCycles::get_number_of_cycles() const { return offsets.size() - 1; }
+
+std::span<const int> FlatCycles::get_cycle(int cycle) const {
+  return std::span<const int>(nodes).subspan(
+      offsets[cycle], offsets[cycle + 1] - offsets[cycle]);
+}
+
+std::vector<std::vector<int>> FlatCycles::to_vectors() const {
   std::vector<std::vector<int>> cycles;
-  for (auto& node : graph.get_nodes()) {
-    int node_id = node.get_id();
-    for (auto& edge : node.get_edges()) {
-      int neighbor_id = edge.get_to().get_id();
-      if (node_id > neighbor_id) continue;
-      if (spanning->has_edge(node_id, neighbor_id)) continue;
-      int common_ancestor =
-          compute_common_ancestor(*spanning, node_id, neighbor_id);
-      std::vector<int> path1 = get_path_from_root(*spanning, node_id);
-      std::vector<int> path2 = get_path_from_root(*spanning, neighbor_id);
-      std::reverse(path1.begin(), path1.end());
-      std::reverse(path2.begin(), path2.end());
-      while (path1.back() != common_ancestor) path1.pop_back();
-      while (path2.back() != common_ancestor) path2.pop_back();
-      std::reverse(path1.begin(), path1.end());
-      path1.insert(path1.end(), path2.begin(), path2.end());
-      path1.pop_back();
-      cycles.push_back(path1);
+  cycles.reserve(get_number_of_cycles());
+  for (int k = 0; k < get_number_of_cycles(); ++k) {
+    auto cycle = get_cycle(k);
+    cycles.emplace_back(cycle.begin(), cycle.end());
+  }
+  return cycles;
+}
+
+FlatCycles compute_flat_cycle_basis(const Graph& graph) {
+  return compute_flat_cycle_basis(FrozenGraph(graph));
+}
+
+FlatCycles compute_flat_cycle_basis(const FrozenGraph& graph) {
+  int n = graph.size();
+  std::vector<int> parent(n, -1);
+  std::vector<int> depth(n, -1);
+  std::vector<int> queue;
+  queue.reserve(n);
+  int max_depth = 0;
+  for (int root = 0; root < n; ++root) {
+    if (depth[root] != -1) continue;
+    depth[root] = 0;
+    parent[root] = root;  // the ancestor tables stop at the root
+    queue.push_back(root);
+    for (int k = queue.size() - 1; k < queue.size(); ++k) {
+      int node = queue[k];
+      for (int neighbor : graph.get_neighbors(node))
+        if (depth[neighbor] == -1) {
+          depth[neighbor] = depth[node] + 1;
+          max_depth = std::max(max_depth, depth[neighbor]);
+          parent[neighbor] = node;
+          queue.push_back(neighbor);
+        }
+    }
+  }
+  // binary lifting, ancestors[j * n + v] is the 2^j-th ancestor of v
+  int levels = 1;
+  while ((1 << levels) <= max_depth) ++levels;
+  std::vector<int> ancestors(levels * n);
+  std::copy(parent.begin(), parent.end(), ancestors.begin());
+  for (int j = 1; j < levels; ++j) {
+    const int* half = ancestors.data() + (j - 1) * n;
+    for (int v = 0; v < n; ++v) ancestors[j * n + v] = half[half[v]];
+  }
+  auto lowest_common_ancestor = [&](int u, int v) {
+    if (depth[u] < depth[v]) std::swap(u, v);
+    for (int j = levels - 1; j >= 0; --j)
+      if (depth[u] - (1 << j) >= depth[v]) u = ancestors[j * n + u];
+    if (u == v) return u;
+    for (int j = levels - 1; j >= 0; --j)
+      if (ancestors[j * n + u] != ancestors[j * n + v]) {
+        u = ancestors[j * n + u];
+        v = ancestors[j * n + v];
+      }
+    return parent[u];
+  };
+  // first pass: the non-tree edges, their common ancestors and the exact
+  // size of the buffer, so that the cycles are written without reallocations
+  struct NonTreeEdge {
+    int node;
+    int neighbor;
+    int ancestor;
+  };
+  std::vector<NonTreeEdge> non_tree_edges;
+  non_tree_edges.reserve(std::max(0, graph.get_number_of_edges() / 2 - n + 1));
+  FlatCycles cycles;
+  for (int node = 0; node < n; ++node) {
+    int node_id = graph.get_id(node);
+    for (int neighbor : graph.get_neighbors(node)) {
+      if (node_id > graph.get_id(neighbor)) continue;
+      if (parent[neighbor] == node || parent[node] == neighbor) continue;
+      int ancestor = lowest_common_ancestor(node, neighbor);
+      non_tree_edges.push_back({node, neighbor, ancestor});
+      cycles.offsets.push_back(cycles.offsets.back() + depth[node] +
+                               depth[neighbor] - 2 * depth[ancestor] + 1);
     }
   }
+  // second pass: each cycle is ancestor -> ... -> node followed by
+  // neighbor -> ... up to the ancestor (excluded)
+  cycles.nodes.resize(cycles.offsets.back());
+  for (int k = 0; k < non_tree_edges.size(); ++k) {
+    auto [node, neighbor, ancestor] = non_tree_edges[k];
+    int* cycle = cycles.nodes.data() + cycles.offsets[k];
+    int from_node = depth[node] - depth[ancestor];
+    cycle[0] = graph.get_id(ancestor);
+    for (int u = node, i = from_node; i > 0; u = parent[u], --i)
+      cycle[i] = graph.get_id(u);
+    for (int v = neighbor, i = from_node + 1; v != ancestor; v = parent[v])
+      cycle[i++] = graph.get_id(v);
+  }
+  return cycles;
+}
+
+std::vector<std::vector<int>> compute_minimum_cycle_basis(const Graph& graph) {
+  return compute_minimum_cycle_basis(FrozenGraph(graph));
+}
+
+// above this many horton candidates the bfs basis is returned instead, they
+// are about nodes times the dimension of the cycle space
+constexpr long long MINIMUM_CYCLE_BASIS_MAX_CANDIDATES = 1 << 22;
+
+// horton: the candidates are root -> x, (x, y), y -> root through the bfs
+// tree of every root, the shortest ones that are independent over GF(2) (as
+// sets of edges) form a basis of minimum total length; only one bfs tree is
+// kept, it is computed again whenever the root of the candidate changes
+std::vector<std::vector<int>> compute_minimum_cycle_basis(
+    const FrozenGraph& graph) {
+  int n = graph.size();
+  // every undirected edge gets an index, shared by its two directions
+  std::vector<int> edge_of_target(graph.get_number_of_edges(), -1);
+  std::vector<int> edge_offsets(n + 1, 0);
+  for (int node = 0; node < n; ++node)
+    edge_offsets[node + 1] = edge_offsets[node] + graph.get_degree(node);
+  int number_of_edges = 0;
+  for (int node = 0; node < n; ++node) {
+    auto neighbors = graph.get_neighbors(node);
+    for (size_t k = 0; k < neighbors.size(); ++k) {
+      if (neighbors[k] < node) continue;
+      edge_of_target[edge_offsets[node] + k] = number_of_edges;
+      auto back = graph.get_neighbors(neighbors[k]);
+      int position = std::find(back.begin(), back.end(), node) - back.begin();
+      edge_of_target[edge_offsets[neighbors[k]] + position] = number_of_edges;
+      ++number_of_edges;
+    }
+  }
+  // bfs tree of a single root
+  std::vector<int> tree_parent(n, -1);
+  std::vector<int> tree_edge(n, -1);
+  std::vector<int> tree_distance(n, -1);
+  std::vector<int> queue;
+  int tree_root = -1;
+  auto compute_tree = [&](int root) {
+    for (int node : queue) tree_distance[node] = -1;
+    tree_root = root;
+    queue.assign(1, root);
+    tree_distance[root] = 0;
+    tree_parent[root] = -1;
+    tree_edge[root] = -1;
+    for (size_t k = 0; k < queue.size(); ++k) {
+      int node = queue[k];
+      auto neighbors = graph.get_neighbors(node);
+      for (size_t i = 0; i < neighbors.size(); ++i)
+        if (tree_distance[neighbors[i]] == -1) {
+          tree_distance[neighbors[i]] = tree_distance[node] + 1;
+          tree_parent[neighbors[i]] = node;
+          tree_edge[neighbors[i]] = edge_of_target[edge_offsets[node] + i];
+          queue.push_back(neighbors[i]);
+        }
+    }
+  };
+  int number_of_components = 0;
+  std::vector<bool> is_reached(n, false);
+  for (int root = 0; root < n; ++root) {
+    if (is_reached[root]) continue;
+    ++number_of_components;
+    compute_tree(root);
+    for (int node : queue) is_reached[node] = true;
+  }
+  int dimension = number_of_edges - n + number_of_components;
+  if ((long long)n * dimension > MINIMUM_CYCLE_BASIS_MAX_CANDIDATES)
+    return compute_cycle_basis(graph);
+  struct Candidate {
+    int length;
+    int root;
+    int from;
+    int to;
+    int edge;
+  };
+  std::vector<Candidate> candidates;
+  for (int root = 0; root < n; ++root) {
+    compute_tree(root);
+    for (int node : queue) {
+      auto neighbors = graph.get_neighbors(node);
+      for (size_t i = 0; i < neighbors.size(); ++i) {
+        int neighbor = neighbors[i];
+        if (node > neighbor) continue;
+        int edge = edge_of_target[edge_offsets[node] + i];
+        if (tree_edge[node] == edge || tree_edge[neighbor] == edge) continue;
+        candidates.push_back({tree_distance[node] + tree_distance[neighbor] + 1,
+                              root, node, neighbor, edge});
+      }
+    }
+  }
+  // candidates of the same length stay grouped by root, so that the trees
+  // are computed again as rarely as possible
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& a, const Candidate& b) {
+                     return a.length < b.length;
+                   });
+  // gaussian elimination on bit rows, pivot_row[e] is the row whose lowest
+  // edge is e
+  size_t words = (number_of_edges + 63) / 64;
+  std::vector<uint64_t> rows;
+  std::vector<int> pivot_row(number_of_edges, -1);
+  std::vector<uint64_t> row(words);
+  std::vector<int> last_seen(n, -1);
+  std::vector<std::vector<int>> cycles;
+  std::vector<int> path_from_to;
+  for (size_t k = 0;
+       k < candidates.size() && (int)cycles.size() < dimension; ++k) {
+    auto [length, root, from, to, edge] = candidates[k];
+    if (root != tree_root) compute_tree(root);
+    // the two tree paths may share more than the root, then it is no cycle
+    bool is_simple = true;
+    std::fill(row.begin(), row.end(), 0);
+    row[edge / 64] ^= uint64_t(1) << (edge % 64);
+    for (int u = from; u != root; u = tree_parent[u]) {
+      last_seen[u] = (int)k;
+      row[tree_edge[u] / 64] ^= uint64_t(1) << (tree_edge[u] % 64);
+    }
+    for (int v = to; v != root; v = tree_parent[v]) {
+      if (last_seen[v] == (int)k) is_simple = false;
+      row[tree_edge[v] / 64] ^= uint64_t(1) << (tree_edge[v] % 64);
+    }
+    if (!is_simple) continue;
+    bool is_independent = false;
+    for (size_t word = 0; word < words && !is_independent; ++word)
+      while (row[word] != 0) {
+        int lowest = word * 64 + std::countr_zero(row[word]);
+        if (pivot_row[lowest] == -1) {
+          pivot_row[lowest] = rows.size() / words;
+          rows.insert(rows.end(), row.begin(), row.end());
+          is_independent = true;
+          break;
+        }
+        const uint64_t* pivot = rows.data() + (size_t)pivot_row[lowest] * words;
+        for (size_t i = word; i < words; ++i) row[i] ^= pivot[i];
+      }
+    if (!is_independent) continue;
+    std::vector<int> cycle;
+    cycle.reserve(length);
+    for (int u = from; u != root; u = tree_parent[u])
+      cycle.push_back(graph.get_id(u));
+    cycle.push_back(graph.get_id(root));
+    std::reverse(cycle.begin(), cycle.end());
+    path_from_to.clear();
+    for (int v = to; v != root; v = tree_parent[v])
+      path_from_to.push_back(graph.get_id(v));
+    cycle.insert(cycle.end(), path_from_to.begin(), path_from_to.end());
+    cycles.push_back(std::move(cycle));
+  }
   return cycles;
 }
 
@@ -216,138 +472,188 @@ std::vector<std::unique_ptr<Graph>> compute_connected_components(
     const Graph& graph) {
   if (!is_graph_undirected(graph))
     throw std::runtime_error("Graph is not undirected");
-  std::unordered_set<int> visited;
   std::vector<std::unique_ptr<Graph>> components;
-  std::function<void(const GraphNode&, Graph& component)> explore_component =
-      [&](const GraphNode& node, Graph& component) {
-        visited.insert(node.get_id());
-        for (const auto& edge : node.get_edges()) {
-          const auto& neighbor = edge.get_to();
-          if (!component.has_node(neighbor.get_id()))
-            component.add_node(neighbor.get_id());
-          if (!component.has_edge(node.get_id(), neighbor.get_id()))
-            component.add_undirected_edge(node.get_id(), neighbor.get_id());
-          if (!visited.contains(neighbor.get_id())) {
-            explore_component(neighbor, component);
-          }
+  if (graph.size() > 0 && is_graph_connected(graph)) {
+    components.push_back(std::make_unique<Graph>(graph.clone()));
+    return components;
+  }
+  FrozenGraph frozen(graph);
+  std::vector<bool> visited(frozen.size(), false);
+  std::vector<int> stack;
+  for (int root = 0; root < frozen.size(); ++root) {
+    if (visited[root]) continue;
+    GraphBuilder component;
+    visited[root] = true;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      int node = stack.back();
+      stack.pop_back();
+      component.add_node(frozen.get_id(node));
+      for (int neighbor : frozen.get_neighbors(node)) {
+        component.add_edge(frozen.get_id(node), frozen.get_id(neighbor));
+        if (!visited[neighbor]) {
+          visited[neighbor] = true;
+          stack.push_back(neighbor);
         }
-      };
-  for (const auto& node : graph.get_nodes())
-    if (!visited.contains(node.get_id())) {
-      auto new_component = std::make_unique<Graph>();
-      new_component->add_node(node.get_id());
-      explore_component(node, *new_component);
-      components.push_back(std::move(new_component));
+      }
     }
-  return std::move(components);
+    components.push_back(component.finalize());
+  }
+  return components;
 }
 
-void dfs_bic_com(const GraphNode& node,
-                 std::unordered_map<int, int>& old_node_id_to_new_id,
-                 std::unordered_map<int, int>& prev_of_node,
-                 int& next_id_to_assign,
-                 std::unordered_map<int, int>& low_point,
-                 std::list<int>& stack_of_nodes,
-                 std::list<std::pair<int, int>>& stack_of_edges,
-                 std::vector<std::unique_ptr<Graph>>& components,
-                 std::unordered_set<int>& cut_vertices);
-
 BiconnectedComponents compute_biconnected_components(const Graph& graph) {
-  std::unordered_map<int, int> old_node_id_to_new_id;
-  std::unordered_map<int, int> prev_of_node;
-  std::unordered_map<int, int> low_point;
-  std::unordered_set<int> cut_vertices;
-  std::vector<std::unique_ptr<Graph>> components;
-  int next_id_to_assign = 0;
-  std::list<int> stack_of_nodes{};
-  std::list<std::pair<int, int>> stack_of_edges{};
-  for (auto& node : graph.get_nodes())
-    if (!old_node_id_to_new_id.contains(node.get_id()))  // node not visited
-      dfs_bic_com(node, old_node_id_to_new_id, prev_of_node, next_id_to_assign,
-                  low_point, stack_of_nodes, stack_of_edges, components,
-                  cut_vertices);
-  if (stack_of_nodes.size() > 0 || stack_of_edges.size() > 0)
-    throw std::runtime_error(
-        "Biconnected components algorithm did not finish correctly");
+  return compute_biconnected_components(FrozenGraph(graph));
+}
+
+BiconnectedComponents compute_biconnected_components(
+    const FrozenGraph& graph) {
+  BlockCutTree tree = compute_block_cut_tree(graph);
   BiconnectedComponents result;
-  result.cutvertices = std::move(cut_vertices);
-  result.components = std::move(components);
+  result.cutvertices.insert(tree.cut_vertices.begin(), tree.cut_vertices.end());
+  for (int block = 0; block < tree.get_number_of_blocks(); ++block) {
+    auto nodes = tree.get_block_nodes(block);
+    auto edges = tree.get_block_edges(block);
+    GraphBuilder component;
+    component.reserve(nodes.size(), 2 * edges.size());
+    for (int node_id : nodes) component.add_node(node_id);
+    for (auto [from_id, to_id] : edges)
+      component.add_undirected_edge(from_id, to_id);
+    result.components.push_back(component.finalize());
+  }
   return result;
 }
 
-void build_component(Graph& component, std::list<int>& nodes,
-                     std::list<std::pair<int, int>>& edges);
-
-void dfs_bic_com(const GraphNode& node,
-                 std::unordered_map<int, int>& old_node_id_to_new_id,
-                 std::unordered_map<int, int>& prev_of_node,
-                 int& next_id_to_assign,
-                 std::unordered_map<int, int>& low_point,
-                 std::list<int>& stack_of_nodes,
-                 std::list<std::pair<int, int>>& stack_of_edges,
-                 std::vector<std::unique_ptr<Graph>>& components,
-                 std::unordered_set<int>& cut_vertices) {
-  int node_id = node.get_id();
-  old_node_id_to_new_id[node_id] = next_id_to_assign;
-  low_point[node_id] = next_id_to_assign;
-  ++next_id_to_assign;
-  int children_number = 0;
-  for (const GraphEdge& edge : node.get_edges()) {
-    const GraphNode& neighbor = edge.get_to();
-    int neighbor_id = neighbor.get_id();
-    if (prev_of_node.contains(node_id) && prev_of_node[node_id] == neighbor_id)
+int BlockCutTree::get_number_of_blocks() const {
+  return block_node_offsets.size() - 1;
+}
+
+std::span<const int> BlockCutTree::get_block_nodes(int block) const {
+  return std::span<const int>(block_nodes).subspan(
+      block_node_offsets[block],
+      block_node_offsets[block + 1] - block_node_offsets[block]);
+}
+
+std::span<const std::pair<int, int>> BlockCutTree::get_block_edges(
+    int block) const {
+  return std::span<const std::pair<int, int>>(block_edges)
+      .subspan(block_edge_offsets[block],
+               block_edge_offsets[block + 1] - block_edge_offsets[block]);
+}
+
+std::span<const int> BlockCutTree::get_blocks_of_cut_vertex(
+    int position) const {
+  return std::span<const int>(cut_vertex_blocks)
+      .subspan(cut_vertex_block_offsets[position],
+               cut_vertex_block_offsets[position + 1] -
+                   cut_vertex_block_offsets[position]);
+}
+
+BlockCutTree compute_block_cut_tree(const Graph& graph) {
+  return compute_block_cut_tree(FrozenGraph(graph));
+}
+
+// iterative hopcroft-tarjan, the edges of the open blocks wait on a single
+// stack until a tree edge with a high enough low point closes their block
+BlockCutTree compute_block_cut_tree(const FrozenGraph& graph) {
+  struct Frame {
+    int node;
+    int parent;
+    int next_neighbor;
+  };
+  BlockCutTree tree;
+  std::vector<int> discovery(graph.size(), -1);
+  std::vector<int> low_point(graph.size(), -1);
+  std::vector<int> last_block_of_node(graph.size(), -1);
+  std::vector<bool> is_cut_vertex(graph.size(), false);
+  std::vector<std::pair<int, int>> stack_of_edges;
+  std::vector<Frame> stack;
+  int next_id_to_assign = 0;
+  auto add_node_to_block = [&](int node, int block) {
+    if (last_block_of_node[node] == block) return;
+    last_block_of_node[node] = block;
+    tree.block_nodes.push_back(graph.get_id(node));
+  };
+  auto close_block = [&]() {
+    tree.block_node_offsets.push_back(tree.block_nodes.size());
+    tree.block_edge_offsets.push_back(tree.block_edges.size());
+  };
+  for (int root = 0; root < graph.size(); ++root) {
+    if (discovery[root] != -1) continue;
+    discovery[root] = low_point[root] = next_id_to_assign++;
+    if (graph.get_degree(root) == 0) {  // node is isolated
+      add_node_to_block(root, tree.get_number_of_blocks());
+      close_block();
       continue;
-    if (!old_node_id_to_new_id.contains(
-            neighbor_id)) {  // means node is not visited
-      std::list<int> new_stack_of_nodes{};
-      std::list<std::pair<int, int>> new_stack_of_edges{};
-      ++children_number;
-      prev_of_node[neighbor_id] = node_id;
-      new_stack_of_nodes.push_back(neighbor_id);
-      new_stack_of_edges.push_back(std::make_pair(node_id, neighbor_id));
-      dfs_bic_com(neighbor, old_node_id_to_new_id, prev_of_node,
-                  next_id_to_assign, low_point, new_stack_of_nodes,
-                  new_stack_of_edges, components, cut_vertices);
-      if (low_point[neighbor_id] < low_point[node_id])
-        low_point[node_id] = low_point[neighbor_id];
-      if (low_point[neighbor_id] >= old_node_id_to_new_id[node_id]) {
-        new_stack_of_nodes.push_back(node_id);
-        components.push_back(std::make_unique<Graph>());
-        build_component(*components.back(), new_stack_of_nodes,
-                        new_stack_of_edges);
-        if (prev_of_node.contains(
-                node_id))  // the root needs to be handled differently
-          // (handled at end of function)
-          cut_vertices.insert(node_id);
-      } else {
-        stack_of_nodes.splice(stack_of_nodes.end(), new_stack_of_nodes);
-        stack_of_edges.splice(stack_of_edges.end(), new_stack_of_edges);
-      }
-    } else {  // node got already visited
-      int neighbor_node_id = old_node_id_to_new_id[neighbor_id];
-      if (neighbor_node_id < old_node_id_to_new_id[node_id]) {
-        stack_of_edges.push_back(std::make_pair(node_id, neighbor_id));
-        if (neighbor_node_id < low_point[node_id])
-          low_point[node_id] = neighbor_node_id;
+    }
+    int children_of_root = 0;
+    stack.push_back({root, -1, 0});
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      int node = frame.node;
+      auto neighbors = graph.get_neighbors(node);
+      if (frame.next_neighbor < neighbors.size()) {
+        int neighbor = neighbors[frame.next_neighbor++];
+        if (neighbor == frame.parent) continue;
+        if (discovery[neighbor] == -1) {  // tree edge
+          if (node == root) ++children_of_root;
+          stack_of_edges.push_back({node, neighbor});
+          discovery[neighbor] = low_point[neighbor] = next_id_to_assign++;
+          stack.push_back({neighbor, node, 0});
+        } else if (discovery[neighbor] < discovery[node]) {  // back edge
+          stack_of_edges.push_back({node, neighbor});
+          low_point[node] = std::min(low_point[node], discovery[neighbor]);
+        }
+        continue;
       }
+      int parent = frame.parent;
+      stack.pop_back();
+      if (parent == -1) continue;
+      low_point[parent] = std::min(low_point[parent], low_point[node]);
+      if (low_point[node] < discovery[parent]) continue;
+      // parent separates the subtree of node, its block is complete
+      int block = tree.get_number_of_blocks();
+      std::pair<int, int> tree_edge{parent, node};
+      std::pair<int, int> edge;
+      do {
+        edge = stack_of_edges.back();
+        stack_of_edges.pop_back();
+        add_node_to_block(edge.first, block);
+        add_node_to_block(edge.second, block);
+        tree.block_edges.emplace_back(graph.get_id(edge.first),
+                                      graph.get_id(edge.second));
+      } while (edge != tree_edge);
+      close_block();
+      if (parent != root) is_cut_vertex[parent] = true;
     }
+    if (children_of_root >= 2) is_cut_vertex[root] = true;
   }
-  if (!prev_of_node.contains(
-          node_id)) {  // handling of node with no parents (the root)
-    if (children_number >= 2)
-      cut_vertices.insert(node_id);
-    else if (children_number == 0) {  // node is isolated
-      components.push_back(std::make_unique<Graph>());
-      components.back()->add_node(node_id);
-    }
+  if (!stack_of_edges.empty())
+    throw std::runtime_error(
+        "Biconnected components algorithm did not finish correctly");
+  std::vector<int> position_of_cut_vertex(graph.size(), -1);
+  for (int node = 0; node < graph.size(); ++node) {
+    if (!is_cut_vertex[node]) continue;
+    position_of_cut_vertex[node] = tree.cut_vertices.size();
+    tree.cut_vertices.push_back(graph.get_id(node));
   }
-}
-
-void build_component(Graph& component, std::list<int>& nodes,
-                     std::list<std::pair<int, int>>& edges) {
-  for (int node : nodes) component.add_node(node);
-  for (const auto& edge : edges)
-    component.add_undirected_edge(edge.first, edge.second);
+  // counting sort of the (cut vertex, block) pairs by cut vertex
+  std::vector<int>& offsets = tree.cut_vertex_block_offsets;
+  offsets.assign(tree.cut_vertices.size() + 1, 0);
+  for (int node_id : tree.block_nodes) {
+    int position = position_of_cut_vertex[graph.get_index(node_id)];
+    if (position != -1) ++offsets[position + 1];
+  }
+  for (int i = 0; i < tree.cut_vertices.size(); ++i)
+    offsets[i + 1] += offsets[i];
+  tree.cut_vertex_blocks.resize(offsets.back());
+  std::vector<int> next_slot(offsets.begin(), offsets.end() - 1);
+  for (int block = 0; block < tree.get_number_of_blocks(); ++block)
+    for (int node_id : tree.get_block_nodes(block)) {
+      int position = position_of_cut_vertex[graph.get_index(node_id)];
+      if (position != -1) tree.cut_vertex_blocks[next_slot[position]++] = block;
+    }
+  return tree;
 }
 
 std::string BiconnectedComponents::to_string() const {
@@ -367,8 +673,14 @@ void BiconnectedComponents::print() const {
 
 std::pair<std::unique_ptr<Graph>, GraphEdgeHashSet>
 compute_maximal_degree_4_subgraph(const Graph& graph) {
-  auto subgraph = std::make_unique<Graph>();
   GraphEdgeHashSet removed_edges;
+  bool has_degree_more_than_4 = false;
+  for (const auto& node : graph.get_nodes())
+    if (node.get_degree() > 4) has_degree_more_than_4 = true;
+  if (!has_degree_more_than_4)
+    return std::make_pair(std::make_unique<Graph>(graph.clone()),
+                          std::move(removed_edges));
+  auto subgraph = std::make_unique<Graph>();
   for (const auto& node : graph.get_nodes()) subgraph->add_node(node.get_id());
   for (const auto& node : graph.get_nodes()) {
     int node_id = node.get_id();
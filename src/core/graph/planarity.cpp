@@ -0,0 +1,81 @@
+#include "core/graph/planarity.hpp"
+
+#include <ogdf/basic/CombinatorialEmbedding.h>
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/extended_graph_alg.h>
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+std::vector<std::vector<int>> split_closed_walk_into_cycles(
+    const std::vector<int>& walk) {
+  std::vector<std::vector<int>> cycles;
+  std::vector<int> stack;
+  std::unordered_map<int, int> position_in_stack;
+  auto close_cycle = [&](int start) {
+    if (stack.size() - start >= 3)
+      cycles.emplace_back(stack.begin() + start, stack.end());
+    for (int i = start + 1; i < stack.size(); ++i)
+      position_in_stack.erase(stack[i]);
+    stack.resize(start + 1);
+  };
+  for (int node : walk) {
+    auto it = position_in_stack.find(node);
+    if (it != position_in_stack.end()) {
+      close_cycle(it->second);
+      continue;
+    }
+    position_in_stack[node] = stack.size();
+    stack.push_back(node);
+  }
+  // the walk goes back to its first node
+  if (!stack.empty()) close_cycle(0);
+  return cycles;
+}
+
+std::optional<std::vector<std::vector<int>>> compute_planar_faces_cycles(
+    const Graph& graph) {
+  ogdf::Graph G;
+  std::unordered_map<int, ogdf::node> nodes;
+  ogdf::NodeArray<int> node_ids(G);
+  for (auto& node : graph.get_nodes()) {
+    ogdf::node v = G.newNode();
+    nodes[node.get_id()] = v;
+    node_ids[v] = node.get_id();
+  }
+  for (auto& node : graph.get_nodes()) {
+    int i = node.get_id();
+    for (const auto& edge : node.get_edges()) {
+      int j = edge.get_to().get_id();
+      if (i < j) G.newEdge(nodes[i], nodes[j]);
+    }
+  }
+  if (!ogdf::planarEmbed(G)) return std::nullopt;
+  std::vector<std::vector<int>> cycles;
+  if (G.numberOfEdges() == 0) return cycles;
+  ogdf::ConstCombinatorialEmbedding embedding(G);
+  std::set<std::vector<std::pair<int, int>>> added_cycles;
+  std::vector<int> walk;
+  std::vector<std::pair<int, int>> cycle_edges;
+  for (ogdf::face f : embedding.faces) {
+    walk.clear();
+    ogdf::adjEntry adj = f->firstAdj();
+    do {
+      walk.push_back(node_ids[adj->theNode()]);
+      adj = adj->faceCycleSucc();
+    } while (adj != f->firstAdj());
+    for (auto& cycle : split_closed_walk_into_cycles(walk)) {
+      // a cycle that is a whole biconnected component bounds two faces
+      cycle_edges.clear();
+      for (int k = 0; k < cycle.size(); ++k)
+        cycle_edges.push_back(
+            std::minmax(cycle[k], cycle[(k + 1) % cycle.size()]));
+      std::sort(cycle_edges.begin(), cycle_edges.end());
+      if (added_cycles.insert(cycle_edges).second)
+        cycles.push_back(std::move(cycle));
+    }
+  }
+  return cycles;
+}
@@ -0,0 +1,61 @@
+#include "core/thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int number_of_threads) {
+  for (int i = 0; i < number_of_threads; ++i)
+    m_threads.emplace_back([this]() { run_thread(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_task_added.notify_all();
+  for (auto& thread : m_threads) thread.join();
+}
+
+void ThreadPool::run_task(Batch& batch, std::unique_lock<std::mutex>& lock) {
+  int index = batch.next_task++;
+  if (batch.next_task == batch.number_of_tasks)
+    m_batches.erase(std::find(m_batches.begin(), m_batches.end(), &batch));
+  lock.unlock();
+  std::exception_ptr error;
+  try {
+    (*batch.task)(index);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  lock.lock();
+  if (error != nullptr && batch.error == nullptr) batch.error = error;
+  if (--batch.unfinished_tasks == 0) m_task_finished.notify_all();
+}
+
+void ThreadPool::run_thread() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_task_added.wait(lock,
+                      [this]() { return m_stopping || !m_batches.empty(); });
+    if (m_stopping) return;
+    run_task(*m_batches.back(), lock);
+  }
+}
+
+void ThreadPool::run(int number_of_tasks,
+                     const std::function<void(int)>& task) {
+  if (number_of_tasks <= 0) return;
+  Batch batch{&task, number_of_tasks, 0, number_of_tasks, nullptr};
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_batches.push_back(&batch);
+  m_task_added.notify_all();
+  while (batch.next_task < batch.number_of_tasks) run_task(batch, lock);
+  m_task_finished.wait(lock, [&]() { return batch.unfinished_tasks == 0; });
+  if (batch.error != nullptr) std::rethrow_exception(batch.error);
+}
+
+ThreadPool& get_thread_pool() {
+  static ThreadPool pool(
+      std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
@@ -0,0 +1,30 @@
+#include <iostream>
+#include <vector>
+
+#include "orthogonal/drawing_benchmark.hpp"
+
+// draws every graph of the folder once per cycle basis, one csv row per graph
+// and basis, then the totals of each basis
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <graphs folder>" << std::endl;
+    return 1;
+  }
+  std::vector<DrawingSetting> settings;
+  for (auto basis : {CycleBasisType::BFS, CycleBasisType::MINIMUM,
+                     CycleBasisType::FACES}) {
+    DrawingOptions options;
+    options.cycle_basis = basis;
+    settings.push_back({cycle_basis_type_to_string(basis), options});
+  }
+  DrawingColumn cycles_length = {
+      "cycles_length", [](const Graph& graph, const DrawingOptions& options) {
+        long long length = 0;
+        for (const auto& cycle :
+             compute_initial_cycles(graph, options.cycle_basis))
+          length += cycle.size();
+        return length;
+      }};
+  run_drawing_benchmark(argv[1], "basis", settings, {cycles_length});
+  return 0;
+}
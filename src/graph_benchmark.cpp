@@ -0,0 +1,188 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/graph/graph.hpp"
+
+// the hash map layout Graph used before its slot storage, kept here as the
+// baseline of the microbenchmarks
+class HashMapGraph {
+ private:
+  struct Node {
+    int id;
+  };
+  struct Edge {
+    int id;
+    int from;
+    int to;
+  };
+  int m_next_node_id = 0;
+  int m_next_edge_id = 0;
+  std::unordered_map<int, std::unique_ptr<Node>> m_nodeid_to_node_map;
+  std::unordered_map<int, std::unordered_set<int>> m_nodeid_to_edgesid;
+  std::unordered_map<int, std::unordered_map<int, int>>
+      m_nodeid_to_neighborsid_to_edgesid;
+  std::unordered_map<int, std::unique_ptr<Edge>> m_edgeid_to_edge_map;
+  std::unordered_map<int, std::unordered_set<int>>
+      m_nodeid_to_incoming_edgesid_map;
+
+ public:
+  bool has_node(int id) const { return m_nodeid_to_node_map.contains(id); }
+  int add_node(int id) {
+    if (has_node(id))
+      throw std::runtime_error("HashMapGraph::add_node: node already exists");
+    m_nodeid_to_node_map[id] = std::make_unique<Node>(Node{id});
+    m_nodeid_to_edgesid[id] = std::unordered_set<int>();
+    m_nodeid_to_neighborsid_to_edgesid[id] = std::unordered_map<int, int>();
+    m_nodeid_to_incoming_edgesid_map[id] = std::unordered_set<int>();
+    return id;
+  }
+  int add_node() {
+    while (has_node(m_next_node_id)) m_next_node_id++;
+    return add_node(m_next_node_id++);
+  }
+  bool has_edge(int from_id, int to_id) const {
+    if (!has_node(from_id) || !has_node(to_id))
+      throw std::runtime_error("HashMapGraph::has_edge: node not found");
+    return m_nodeid_to_neighborsid_to_edgesid.at(from_id).contains(to_id);
+  }
+  void add_edge(int from_id, int to_id) {
+    if (!has_node(from_id) || !has_node(to_id))
+      throw std::runtime_error("HashMapGraph::add_edge: node not found");
+    if (has_edge(from_id, to_id))
+      throw std::runtime_error("HashMapGraph::add_edge: edge already exists");
+    int edge_id = m_next_edge_id++;
+    m_edgeid_to_edge_map[edge_id] =
+        std::make_unique<Edge>(Edge{edge_id, from_id, to_id});
+    m_nodeid_to_edgesid[from_id].insert(edge_id);
+    m_nodeid_to_neighborsid_to_edgesid[from_id][to_id] = edge_id;
+    m_nodeid_to_incoming_edgesid_map[to_id].insert(edge_id);
+  }
+  void add_undirected_edge(int from_id, int to_id) {
+    add_edge(from_id, to_id);
+    add_edge(to_id, from_id);
+  }
+  void remove_edge(int from_id, int to_id) {
+    if (!has_edge(from_id, to_id))
+      throw std::runtime_error("HashMapGraph::remove_edge: edge not found");
+    int edge_id = m_nodeid_to_neighborsid_to_edgesid.at(from_id).at(to_id);
+    m_nodeid_to_edgesid[from_id].erase(edge_id);
+    m_nodeid_to_neighborsid_to_edgesid[from_id].erase(to_id);
+    m_edgeid_to_edge_map.erase(edge_id);
+    m_nodeid_to_incoming_edgesid_map[to_id].erase(edge_id);
+  }
+  void remove_undirected_edge(int from_id, int to_id) {
+    remove_edge(from_id, to_id);
+    remove_edge(to_id, from_id);
+  }
+  void remove_node(int id) {
+    std::vector<int> neighbors;
+    for (int edge_id : m_nodeid_to_edgesid.at(id))
+      neighbors.push_back(m_edgeid_to_edge_map.at(edge_id)->to);
+    for (int neighbor_id : neighbors) remove_edge(id, neighbor_id);
+    neighbors.clear();
+    for (int edge_id : m_nodeid_to_incoming_edgesid_map.at(id))
+      neighbors.push_back(m_edgeid_to_edge_map.at(edge_id)->from);
+    for (int neighbor_id : neighbors) remove_edge(neighbor_id, id);
+    m_nodeid_to_node_map.erase(id);
+    m_nodeid_to_edgesid.erase(id);
+    m_nodeid_to_neighborsid_to_edgesid.erase(id);
+    m_nodeid_to_incoming_edgesid_map.erase(id);
+  }
+  long long sum_of_neighbors(int id) const {
+    long long sum = 0;
+    for (int edge_id : m_nodeid_to_edgesid.at(id))
+      sum += m_edgeid_to_edge_map.at(edge_id)->to;
+    return sum;
+  }
+};
+
+long long sum_of_neighbors(const HashMapGraph& graph, int id) {
+  return graph.sum_of_neighbors(id);
+}
+
+long long sum_of_neighbors(const Graph& graph, int id) {
+  long long sum = 0;
+  for (auto& edge : graph.get_edges_of_node(id)) sum += edge.get_to().get_id();
+  return sum;
+}
+
+double measure(const std::function<void()>& function) {
+  auto start = std::chrono::high_resolution_clock::now();
+  function();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// a side x side grid, every node has degree at most 4 like the augmented
+// graphs of the drawings
+template <typename G>
+std::vector<double> run_benchmark(int side) {
+  G graph;
+  std::vector<double> times;
+  int n = side * side;
+  times.push_back(measure([&]() {
+    for (int i = 0; i < n; ++i) graph.add_node(i);
+    for (int r = 0; r < side; ++r)
+      for (int c = 0; c < side; ++c) {
+        if (c + 1 < side)
+          graph.add_undirected_edge(r * side + c, r * side + c + 1);
+        if (r + 1 < side)
+          graph.add_undirected_edge(r * side + c, (r + 1) * side + c);
+      }
+  }));
+  long long checksum = 0;
+  times.push_back(measure([&]() {
+    for (int r = 0; r < side; ++r)
+      for (int c = 0; c + 1 < side; ++c)
+        checksum += graph.has_edge(r * side + c, r * side + c + 1);
+    for (int i = 0; i < n; ++i) checksum += graph.has_edge(i, (i * 7) % n);
+  }));
+  times.push_back(measure([&]() {
+    for (int i = 0; i < n; ++i) checksum += sum_of_neighbors(graph, i);
+  }));
+  // the same mutation add_corner_inside_edge does: replace an edge with a
+  // path through a new node
+  times.push_back(measure([&]() {
+    for (int r = 0; r < side; ++r)
+      for (int c = 0; c + 1 < side; ++c) {
+        int from = r * side + c;
+        int to = from + 1;
+        graph.remove_undirected_edge(from, to);
+        int corner;
+        if constexpr (std::is_same_v<G, Graph>)
+          corner = graph.add_node().get_id();
+        else
+          corner = graph.add_node();
+        graph.add_undirected_edge(from, corner);
+        graph.add_undirected_edge(corner, to);
+      }
+  }));
+  times.push_back(measure([&]() {
+    for (int i = 0; i < n; i += 2) graph.remove_node(i);
+  }));
+  if (checksum == -1) std::cout << checksum;  // keeps the loops alive
+  return times;
+}
+
+int main(int argc, char* argv[]) {
+  int side = argc > 1 ? std::stoi(argv[1]) : 300;
+  const std::vector<std::string> phases = {"build", "has_edge", "neighbors",
+                                           "split edges", "remove nodes"};
+  auto hash_map_times = run_benchmark<HashMapGraph>(side);
+  auto slot_times = run_benchmark<Graph>(side);
+  std::cout << "grid " << side << "x" << side << ", times in ms" << std::endl;
+  std::cout << "phase, hash maps, slots, speedup" << std::endl;
+  for (int i = 0; i < phases.size(); ++i)
+    std::cout << phases[i] << ", " << hash_map_times[i] << ", "
+              << slot_times[i] << ", " << hash_map_times[i] / slot_times[i]
+              << std::endl;
+  return 0;
+}
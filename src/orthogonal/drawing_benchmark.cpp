@@ -0,0 +1,86 @@
+#include "orthogonal/drawing_benchmark.hpp"
+
+#include <iostream>
+
+#include "core/graph/file_loader.hpp"
+#include "core/graph/graphs_algorithms.hpp"
+#include "core/utils.hpp"
+
+double elapsed_seconds(std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// totals of the drawings of one setting
+struct DrawingTotals {
+  std::vector<long long> columns;
+  long long initial_cycles = 0;
+  long long added_cycles = 0;
+  long long variables = 0;
+  long long clauses = 0;
+  long long solves = 0;
+  long long conflicts = 0;
+  double sat_time = 0.0;
+  double drawing_time = 0.0;
+};
+
+void run_drawing_benchmark(const std::string& folder,
+                           const std::string& setting_column,
+                           const std::vector<DrawingSetting>& settings,
+                           const std::vector<DrawingColumn>& columns) {
+  std::vector<DrawingTotals> totals(settings.size());
+  for (auto& total : totals) total.columns.assign(columns.size(), 0);
+  std::cout << "graph," << setting_column << ",";
+  for (const auto& column : columns) std::cout << column.name << ",";
+  std::cout << "initial_cycles,added_cycles,cnf_variables,cnf_clauses,"
+               "sat_solves,sat_conflicts,sat_time,drawing_time"
+            << std::endl;
+  std::vector<long long> values(columns.size());
+  for (const auto& path : collect_txt_files(folder)) {
+    auto graph = load_graph_from_txt_file(path);
+    if (!is_graph_connected(*graph)) continue;
+    for (size_t i = 0; i < settings.size(); ++i) {
+      const DrawingOptions& options = settings[i].options;
+      for (size_t k = 0; k < columns.size(); ++k)
+        values[k] = columns[k].compute(*graph, options);
+      auto start = std::chrono::steady_clock::now();
+      DrawingResult result =
+          make_orthogonal_drawing_sperimental(*graph, options);
+      double drawing_time = elapsed_seconds(start);
+      const SatStats& stats = result.sat_stats;
+      std::cout << path << "," << settings[i].name << ",";
+      for (long long value : values) std::cout << value << ",";
+      std::cout << result.initial_number_of_cycles << ","
+                << result.number_of_added_cycles << ","
+                << stats.number_of_variables << "," << stats.number_of_clauses
+                << "," << stats.number_of_solves << ","
+                << stats.number_of_conflicts << "," << stats.solve_time << ","
+                << drawing_time << std::endl;
+      DrawingTotals& total = totals[i];
+      for (size_t k = 0; k < columns.size(); ++k)
+        total.columns[k] += values[k];
+      total.initial_cycles += result.initial_number_of_cycles;
+      total.added_cycles += result.number_of_added_cycles;
+      total.variables += stats.number_of_variables;
+      total.clauses += stats.number_of_clauses;
+      total.solves += stats.number_of_solves;
+      total.conflicts += stats.number_of_conflicts;
+      total.sat_time += stats.solve_time;
+      total.drawing_time += drawing_time;
+    }
+  }
+  std::cout << std::endl << "totals" << std::endl;
+  for (size_t i = 0; i < settings.size(); ++i) {
+    const DrawingTotals& total = totals[i];
+    std::cout << setting_column << "=" << settings[i].name << ":";
+    for (size_t k = 0; k < columns.size(); ++k)
+      std::cout << " " << columns[k].name << " " << total.columns[k] << ",";
+    std::cout << " initial cycles " << total.initial_cycles
+              << ", added cycles " << total.added_cycles << ", cnf variables "
+              << total.variables << ", cnf clauses " << total.clauses
+              << ", sat solves " << total.solves << ", sat conflicts "
+              << total.conflicts << ", sat time " << total.sat_time
+              << "s, drawing time " << total.drawing_time << "s" << std::endl;
+  }
+}
@@ -5,12 +5,17 @@
 #include <cmath>
 #include <functional>
 #include <list>
+#include <numeric>
 #include <queue>
 #include <ranges>
 #include <set>
+#include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "core/graph/graph_builder.hpp"
+#include "core/graph/planarity.hpp"
+#include "core/thread_pool.hpp"
 #include "core/utils.hpp"
 #include "orthogonal/area_compacter.hpp"
 #include "orthogonal/equivalence_classes.hpp"
@@ -253,12 +258,15 @@ bool check_if_drawing_has_overlappings(const Graph& graph,
   return false;
 }
 
-DrawingResult make_orthogonal_drawing_any_degree(const Graph& graph);
+DrawingResult make_orthogonal_drawing_any_degree(
+    const Graph& graph, const DrawingOptions& options);
 
-DrawingResult make_orthogonal_drawing(const Graph& graph) {
+DrawingResult make_orthogonal_drawing(const Graph& graph,
+                                      const DrawingOptions& options) {
   for (const auto& node : graph.get_nodes())
-    if (node.get_degree() > 4) return make_orthogonal_drawing_any_degree(graph);
-  return make_orthogonal_drawing_sperimental(graph);
+    if (node.get_degree() > 4)
+      return make_orthogonal_drawing_any_degree(graph, options);
+  return make_orthogonal_drawing_sperimental(graph, options);
 }
 
 DrawingResult merge_connected_components(std::vector<DrawingResult>& results);
@@ -405,13 +413,14 @@ void shift_edges(GraphAttributes& attributes, int i, int j,
   }
 }
 
-DrawingResult make_orthogonal_drawing_any_degree(const Graph& graph) {
+DrawingResult make_orthogonal_drawing_any_degree(
+    const Graph& graph, const DrawingOptions& options) {
   auto [subgraph, removed_edges] = compute_maximal_degree_4_subgraph(graph);
   auto components = compute_connected_components(*subgraph);
   std::vector<DrawingResult> results;
   for (auto& component : components)
     results.push_back(
-        std::move(make_orthogonal_drawing_sperimental(*component)));
+        std::move(make_orthogonal_drawing_sperimental(*component, options)));
   DrawingResult result = merge_connected_components(results);
   for (auto& edge : removed_edges) {
     if (edge.first > edge.second) continue;
@@ -696,19 +705,73 @@ void all_positive_positions(Graph& graph, NodesPositions& positions) {
 }
 
 DrawingResult make_orthogonal_drawing_incremental(
-    const Graph& graph, std::vector<std::vector<int>>& cycles);
+    const Graph& graph, std::vector<std::vector<int>>& cycles,
+    const DrawingOptions& options);
+
+const std::string cycle_basis_type_to_string(const CycleBasisType type) {
+  switch (type) {
+    case CycleBasisType::BFS:
+      return "bfs";
+    case CycleBasisType::MINIMUM:
+      return "minimum";
+    case CycleBasisType::FACES:
+      return "faces";
+    default:
+      throw std::invalid_argument("Unknown cycle basis type");
+  }
+}
 
-DrawingResult make_orthogonal_drawing_sperimental(const Graph& graph) {
-  auto cycles = compute_cycle_basis(graph);
-  return make_orthogonal_drawing_incremental(graph, cycles);
+CycleBasisType string_to_cycle_basis_type(const std::string& type) {
+  if (type == "bfs") return CycleBasisType::BFS;
+  if (type == "minimum") return CycleBasisType::MINIMUM;
+  if (type == "faces") return CycleBasisType::FACES;
+  throw std::invalid_argument("Invalid cycle basis type string: " + type);
+}
+
+std::vector<std::vector<int>> compute_initial_cycles(const Graph& graph,
+                                                     CycleBasisType type) {
+  if (type == CycleBasisType::MINIMUM)
+    return compute_minimum_cycle_basis(graph);
+  if (type == CycleBasisType::FACES) {
+    auto faces = compute_planar_faces_cycles(graph);
+    if (faces.has_value()) return std::move(faces.value());
+  }
+  return compute_cycle_basis(graph);
+}
+
+// nullopt when the graph must be drawn at once, the solves of the blocks
+// thrown away are added to discarded_sat_stats
+std::optional<DrawingResult> make_orthogonal_drawing_by_blocks(
+    const Graph& graph, const DrawingOptions& options,
+    SatStats& discarded_sat_stats);
+
+DrawingResult make_orthogonal_drawing_sperimental(
+    const Graph& graph, const DrawingOptions& options) {
+  SatStats discarded_sat_stats;
+  if (options.solve_blocks_in_parallel) {
+    auto result =
+        make_orthogonal_drawing_by_blocks(graph, options, discarded_sat_stats);
+    if (result.has_value()) return std::move(result.value());
+  }
+  auto cycles = compute_initial_cycles(graph, options.cycle_basis);
+  DrawingResult result =
+      make_orthogonal_drawing_incremental(graph, cycles, options);
+  if (discarded_sat_stats.number_of_solves > 0) {
+    result.sat_stats.add(discarded_sat_stats);
+    result.has_discarded_blocks = true;
+  }
+  return result;
 }
 
 std::optional<std::vector<int>> check_if_metrics_exist(
     Shape& shape, Graph& graph, GraphAttributes& attributes) {
-  auto [classes_x, classes_y] = build_equivalence_classes(shape, graph);
+  std::pmr::monotonic_buffer_resource scratch;
+  auto [classes_x, classes_y] =
+      build_equivalence_classes(shape, graph, &scratch);
   auto [ordering_x, ordering_y, ordering_x_edge_to_graph_edge,
         ordering_y_edge_to_graph_edge] =
-      equivalence_classes_to_ordering(classes_x, classes_y, graph, shape);
+      equivalence_classes_to_ordering(classes_x, classes_y, graph, shape,
+                                      &scratch);
   auto cycle_x = find_a_cycle_directed_graph(*ordering_x);
   auto cycle_y = find_a_cycle_directed_graph(*ordering_y);
   if (cycle_x.has_value()) {
@@ -728,6 +791,46 @@ std::optional<std::vector<int>> check_if_metrics_exist(
   return std::nullopt;
 }
 
+// like check_if_metrics_exist, but every edge-disjoint cycle of both
+// orderings is returned, so that they can all be added in one round
+std::vector<std::vector<int>> find_all_metrics_conflicts(Shape& shape,
+                                                         Graph& graph) {
+  std::pmr::monotonic_buffer_resource scratch;
+  auto [classes_x, classes_y] =
+      build_equivalence_classes(shape, graph, &scratch);
+  auto [ordering_x, ordering_y, ordering_x_edge_to_graph_edge,
+        ordering_y_edge_to_graph_edge] =
+      equivalence_classes_to_ordering(classes_x, classes_y, graph, shape,
+                                      &scratch);
+  std::vector<std::vector<int>> cycles;
+  auto add_cycle = [&](std::vector<int> cycle) {
+    for (const auto& added : cycles)
+      if (are_cycles_equivalent(added, cycle)) return;
+    cycles.push_back(std::move(cycle));
+  };
+  for (const auto& cycle_x :
+       find_edge_disjoint_cycles_directed_graph(*ordering_x))
+    add_cycle(build_cycle_in_graph_from_cycle_in_ordering(
+        graph, shape, cycle_x, *ordering_x, classes_x,
+        ordering_x_edge_to_graph_edge, false));
+  for (const auto& cycle_y :
+       find_edge_disjoint_cycles_directed_graph(*ordering_y))
+    add_cycle(build_cycle_in_graph_from_cycle_in_ordering(
+        graph, shape, cycle_y, *ordering_y, classes_y,
+        ordering_y_edge_to_graph_edge, true));
+  return cycles;
+}
+
+std::vector<std::vector<int>> find_metrics_conflicts(
+    Shape& shape, Graph& graph, GraphAttributes& attributes,
+    const DrawingOptions& options) {
+  if (options.add_all_conflicting_cycles)
+    return find_all_metrics_conflicts(shape, graph);
+  auto cycle = check_if_metrics_exist(shape, graph, attributes);
+  if (!cycle.has_value()) return {};
+  return {std::move(cycle.value())};
+}
+
 void add_green_blue_nodes(Graph& graph, GraphAttributes& attributes,
                           Shape& shape);
 
@@ -765,34 +868,46 @@ bool has_graph_degree_more_than_4(const Graph& graph) {
   return false;
 }
 
-DrawingResult make_orthogonal_drawing_incremental(
-    const Graph& graph, std::vector<std::vector<int>>& cycles) {
-  if (!is_graph_undirected(graph))
-    throw std::runtime_error(
-        "make_orthogonal_drawing_incremental: graph is not undirected");
-  if (!is_graph_connected(graph))
-    throw std::runtime_error(
-        "make_orthogonal_drawing_incremental: graph is not connected");
-  auto augmented_graph = std::make_unique<Graph>();
-  GraphAttributes attributes;
-  attributes.add_attribute(Attribute::NODES_COLOR);
-  for (const auto& node : graph.get_nodes()) {
-    augmented_graph->add_node(node.get_id());
-    attributes.set_node_color(node.get_id(), Color::BLACK);
-  }
-  for (const auto& node : graph.get_nodes())
-    for (auto& edge : node.get_edges())
-      augmented_graph->add_edge(node.get_id(), edge.get_to().get_id());
-  Shape shape = build_shape(*augmented_graph, attributes, cycles);
-  std::optional<std::vector<int>> cycle_to_add =
-      check_if_metrics_exist(shape, *augmented_graph, attributes);
-  int number_of_added_cycles = 0;
-  while (cycle_to_add.has_value()) {
-    cycles.push_back(*cycle_to_add);
-    number_of_added_cycles++;
-    shape = build_shape(*augmented_graph, attributes, cycles);
-    cycle_to_add = check_if_metrics_exist(shape, *augmented_graph, attributes);
+// solves the shape, then adds the cycles found by the metrics checks and
+// solves again until there are none
+Shape solve_shape(Graph& augmented_graph, GraphAttributes& attributes,
+                  std::vector<std::vector<int>>& cycles,
+                  const DrawingOptions& options, SatStats& sat_stats,
+                  int& number_of_added_cycles) {
+  std::optional<IncrementalShapeBuilder> shape_builder;
+  if (uses_incremental_builder(options.shape_options))
+    shape_builder.emplace(augmented_graph, attributes, cycles,
+                          options.shape_options);
+  Shape shape = (shape_builder.has_value())
+                    ? shape_builder->build_shape()
+                    : build_shape(augmented_graph, attributes, cycles,
+                                  options.shape_options, &sat_stats);
+  auto cycles_to_add =
+      find_metrics_conflicts(shape, augmented_graph, attributes, options);
+  while (!cycles_to_add.empty()) {
+    number_of_added_cycles += cycles_to_add.size();
+    if (shape_builder.has_value()) {
+      for (const auto& cycle : cycles_to_add) shape_builder->add_cycle(cycle);
+      shape = shape_builder->build_shape();
+    } else {
+      for (auto& cycle : cycles_to_add) cycles.push_back(std::move(cycle));
+      // most directions survive a new cycle, the solver starts from them
+      shape = build_shape(augmented_graph, attributes, cycles,
+                          options.shape_options, &sat_stats, &shape);
+    }
+    cycles_to_add =
+        find_metrics_conflicts(shape, augmented_graph, attributes, options);
   }
+  if (shape_builder.has_value()) sat_stats.add(shape_builder->get_sat_stats());
+  return shape;
+}
+
+// everything after the shape, shape must be allocated from memory already
+DrawingResult finish_drawing(
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> memory,
+    std::unique_ptr<Graph> augmented_graph, GraphAttributes attributes,
+    Shape shape, int initial_number_of_cycles, int number_of_added_cycles,
+    const SatStats& sat_stats, const DrawingOptions& options) {
   int old_size = augmented_graph->size();
   refine_result(*augmented_graph, attributes, shape);
   int number_of_useless_bends = old_size - augmented_graph->size();
@@ -807,13 +922,281 @@ DrawingResult make_orthogonal_drawing_incremental(
     positions = build_nodes_positions(*augmented_graph, attributes, shape);
   }
   compact_area(*augmented_graph, shape, positions, attributes);
-  return {std::move(augmented_graph),
+  return {std::move(memory),
+          std::move(augmented_graph),
           std::move(attributes),
           std::move(shape),
           std::move(positions),
-          (int)cycles.size() - number_of_added_cycles,
+          initial_number_of_cycles,
           number_of_added_cycles,
-          number_of_useless_bends};
+          number_of_useless_bends,
+          sat_stats,
+          sat_stats.number_of_unknown_results > 0 ||
+              is_drawing_budget_exhausted(options.shape_options,
+                                          sat_stats.solve_time)};
+}
+
+DrawingResult make_orthogonal_drawing_incremental(
+    const Graph& graph, std::vector<std::vector<int>>& cycles,
+    const DrawingOptions& options) {
+  if (!is_graph_undirected(graph))
+    throw std::runtime_error(
+        "make_orthogonal_drawing_incremental: graph is not undirected");
+  if (!is_graph_connected(graph))
+    throw std::runtime_error(
+        "make_orthogonal_drawing_incremental: graph is not connected");
+  auto memory = std::make_unique<std::pmr::monotonic_buffer_resource>();
+  auto augmented_graph = std::make_unique<Graph>(graph.clone(memory.get()));
+  GraphAttributes attributes(memory.get());
+  attributes.add_attribute(Attribute::NODES_COLOR);
+  for (const auto& node : graph.get_nodes())
+    attributes.set_node_color(node.get_id(), Color::BLACK);
+  SatStats sat_stats;
+  int number_of_added_cycles = 0;
+  Shape shape = solve_shape(*augmented_graph, attributes, cycles, options,
+                            sat_stats, number_of_added_cycles);
+  // the shapes of the rounds above are thrown away, only the last one is kept
+  // in the drawing memory
+  Shape drawing_shape(memory.get());
+  drawing_shape = std::move(shape);
+  return finish_drawing(std::move(memory), std::move(augmented_graph),
+                        std::move(attributes), std::move(drawing_shape),
+                        (int)cycles.size() - number_of_added_cycles,
+                        number_of_added_cycles, sat_stats, options);
+}
+
+struct BlockShape {
+  // the nodes that are not in the block are the corners added to its edges
+  std::unique_ptr<Graph> augmented_graph;
+  Shape shape;
+  int initial_number_of_cycles = 0;
+  int number_of_added_cycles = 0;
+  SatStats sat_stats;
+};
+
+BlockShape solve_block_shape(const Graph& block,
+                             const DrawingOptions& options) {
+  BlockShape result;
+  result.augmented_graph = std::make_unique<Graph>(block.clone());
+  GraphAttributes attributes;
+  attributes.add_attribute(Attribute::NODES_COLOR);
+  for (const auto& node : block.get_nodes())
+    attributes.set_node_color(node.get_id(), Color::BLACK);
+  auto cycles = compute_initial_cycles(block, options.cycle_basis);
+  result.shape =
+      solve_shape(*result.augmented_graph, attributes, cycles, options,
+                  result.sat_stats, result.number_of_added_cycles);
+  result.initial_number_of_cycles =
+      (int)cycles.size() - result.number_of_added_cycles;
+  return result;
+}
+
+// one bit per direction
+int directions_at_node(const BlockShape& block, int node_id) {
+  int directions = 0;
+  const GraphNode& node = block.augmented_graph->get_node_by_id(node_id);
+  for (const auto& edge : node.get_edges()) {
+    Direction direction =
+        block.shape.get_direction(node_id, edge.get_to().get_id());
+    directions |= 1 << static_cast<int>(direction);
+  }
+  return directions;
+}
+
+// the first `rotations` turns of 90 degrees, after a mirror image along the
+// vertical axis if mirror is set
+Direction transform_direction(Direction direction, int rotations,
+                              bool mirror) {
+  if (mirror && (direction == Direction::LEFT || direction == Direction::RIGHT))
+    direction = opposite_direction(direction);
+  for (int k = 0; k < rotations; ++k) direction = rotate_90_degrees(direction);
+  return direction;
+}
+
+int transform_directions(int directions, int rotations, bool mirror) {
+  int result = 0;
+  for (auto direction : get_all_directions())
+    if (directions & (1 << static_cast<int>(direction)))
+      result |= 1 << static_cast<int>(
+                    transform_direction(direction, rotations, mirror));
+  return result;
+}
+
+// turning or mirroring a whole shape keeps it valid, with the same metrics
+void transform_shape(BlockShape& block, int rotations, bool mirror) {
+  Shape shape;
+  for (const auto& node : block.augmented_graph->get_nodes()) {
+    int i = node.get_id();
+    for (const auto& edge : node.get_edges()) {
+      int j = edge.get_to().get_id();
+      shape.set_direction(
+          i, j,
+          transform_direction(block.shape.get_direction(i, j), rotations,
+                              mirror));
+    }
+  }
+  block.shape = std::move(shape);
+}
+
+// a block that no turn fits, with the cut vertex it is placed from and the
+// directions the blocks placed before use there
+struct PortConflict {
+  int block;
+  int cut_vertex;
+  int used_directions;
+};
+
+// port assignment: the blocks are placed along the block-cut tree, each one
+// turned and mirrored so that at its cut vertex it only uses directions that
+// the blocks placed before left free; returns the first block no turn fits,
+// as for two blocks of degree 2 where one uses opposite and the other
+// perpendicular directions, nullopt when all of them are placed
+std::optional<PortConflict> assign_ports(const BlockCutTree& tree,
+                                         std::vector<BlockShape>& blocks) {
+  std::unordered_map<int, int> position_of_cut_vertex;
+  for (int k = 0; k < (int)tree.cut_vertices.size(); ++k)
+    position_of_cut_vertex[tree.cut_vertices[k]] = k;
+  std::vector<int> used_directions(tree.cut_vertices.size(), 0);
+  std::vector<bool> is_placed(blocks.size(), false);
+  auto place = [&](int block) {
+    is_placed[block] = true;
+    for (int node_id : tree.get_block_nodes(block)) {
+      auto it = position_of_cut_vertex.find(node_id);
+      if (it != position_of_cut_vertex.end())
+        used_directions[it->second] |=
+            directions_at_node(blocks[block], node_id);
+    }
+  };
+  std::vector<int> queue = {0};
+  place(0);
+  for (int k = 0; k < (int)queue.size(); ++k)
+    for (int node_id : tree.get_block_nodes(queue[k])) {
+      auto it = position_of_cut_vertex.find(node_id);
+      if (it == position_of_cut_vertex.end()) continue;
+      int position = it->second;
+      for (int block : tree.get_blocks_of_cut_vertex(position)) {
+        if (is_placed[block]) continue;
+        int directions = directions_at_node(blocks[block], node_id);
+        bool is_assigned = false;
+        for (int t = 0; t < 8 && !is_assigned; ++t)
+          if ((transform_directions(directions, t % 4, t >= 4) &
+               used_directions[position]) == 0) {
+            transform_shape(blocks[block], t % 4, t >= 4);
+            is_assigned = true;
+          }
+        if (!is_assigned)
+          return PortConflict{block, node_id, used_directions[position]};
+        place(block);
+        queue.push_back(block);
+      }
+    }
+  return std::nullopt;
+}
+
+std::optional<DrawingResult> make_orthogonal_drawing_by_blocks(
+    const Graph& graph, const DrawingOptions& options,
+    SatStats& discarded_sat_stats) {
+  if (has_graph_degree_more_than_4(graph) || !is_graph_undirected(graph) ||
+      !is_graph_connected(graph))
+    return std::nullopt;
+  BlockCutTree tree = compute_block_cut_tree(graph);
+  int number_of_blocks = tree.get_number_of_blocks();
+  if (number_of_blocks < 2) return std::nullopt;
+  std::vector<std::unique_ptr<Graph>> block_graphs;
+  for (int k = 0; k < number_of_blocks; ++k) {
+    GraphBuilder builder;
+    for (int node_id : tree.get_block_nodes(k)) builder.add_node(node_id);
+    for (auto [from_id, to_id] : tree.get_block_edges(k))
+      builder.add_undirected_edge(from_id, to_id);
+    block_graphs.push_back(builder.finalize());
+  }
+  // largest blocks first, so that the threads end at about the same time
+  std::vector<int> order(number_of_blocks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return block_graphs[a]->size() > block_graphs[b]->size();
+  });
+  std::vector<BlockShape> blocks(number_of_blocks);
+  auto discard_blocks = [&]() {
+    for (const auto& block : blocks) discarded_sat_stats.add(block.sat_stats);
+    return std::nullopt;
+  };
+  get_thread_pool().run(number_of_blocks, [&](int current) {
+    int block = order[current];
+    blocks[block] = solve_block_shape(*block_graphs[block], options);
+  });
+  // the block that does not fit is solved again with the directions taken
+  // at its cut vertex forbidden, so that it fits unturned, and the ports are
+  // assigned again: the blocks placed before keep the same turns
+  std::vector<bool> is_solved_again(number_of_blocks, false);
+  for (auto conflict = assign_ports(tree, blocks); conflict.has_value();
+       conflict = assign_ports(tree, blocks)) {
+    if (is_solved_again[conflict->block]) return discard_blocks();
+    is_solved_again[conflict->block] = true;
+    DrawingOptions block_options = options;
+    block_options.shape_options.forbidden_directions[conflict->cut_vertex] =
+        conflict->used_directions;
+    SatStats first_solve_stats = blocks[conflict->block].sat_stats;
+    blocks[conflict->block] =
+        solve_block_shape(*block_graphs[conflict->block], block_options);
+    blocks[conflict->block].sat_stats.add(first_solve_stats);
+  }
+  // the blocks are glued at the cut vertices, the corners get new ids
+  auto memory = std::make_unique<std::pmr::monotonic_buffer_resource>();
+  auto augmented_graph = std::make_unique<Graph>(memory.get());
+  GraphAttributes attributes(memory.get());
+  attributes.add_attribute(Attribute::NODES_COLOR);
+  Shape shape(memory.get());
+  int next_corner_id = 0;
+  for (const auto& node : graph.get_nodes()) {
+    augmented_graph->add_node(node.get_id());
+    attributes.set_node_color(node.get_id(), Color::BLACK);
+    next_corner_id = std::max(next_corner_id, node.get_id() + 1);
+  }
+  SatStats sat_stats;
+  int initial_number_of_cycles = 0;
+  int number_of_added_cycles = 0;
+  std::unordered_map<int, int> new_id_of_node;
+  for (int k = 0; k < number_of_blocks; ++k) {
+    const BlockShape& block = blocks[k];
+    new_id_of_node.clear();
+    for (int node_id : tree.get_block_nodes(k))
+      new_id_of_node[node_id] = node_id;
+    for (const auto& node : block.augmented_graph->get_nodes())
+      if (!new_id_of_node.contains(node.get_id())) {
+        new_id_of_node[node.get_id()] = next_corner_id;
+        augmented_graph->add_node(next_corner_id);
+        attributes.set_node_color(next_corner_id, Color::RED);
+        ++next_corner_id;
+      }
+    for (const auto& node : block.augmented_graph->get_nodes()) {
+      int i = node.get_id();
+      for (const auto& edge : node.get_edges()) {
+        int j = edge.get_to().get_id();
+        if (i > j) continue;
+        int new_i = new_id_of_node[i];
+        int new_j = new_id_of_node[j];
+        augmented_graph->add_undirected_edge(new_i, new_j);
+        shape.set_direction(new_i, new_j, block.shape.get_direction(i, j));
+        shape.set_direction(new_j, new_i, block.shape.get_direction(j, i));
+      }
+    }
+    sat_stats.add(block.sat_stats);
+    initial_number_of_cycles += block.initial_number_of_cycles;
+    number_of_added_cycles += block.number_of_added_cycles;
+  }
+  // no ordering cycle can go through a cut vertex into another block, as each
+  // block has valid metrics and they only touch at the cut vertices, so this
+  // only guards the gluing; there is no block to blame for a conflict, the
+  // whole graph is drawn at once and the result tells that the blocks were
+  // thrown away
+  if (!find_metrics_conflicts(shape, *augmented_graph, attributes, options)
+           .empty())
+    return discard_blocks();
+  return finish_drawing(std::move(memory), std::move(augmented_graph),
+                        std::move(attributes), std::move(shape),
+                        initial_number_of_cycles, number_of_added_cycles,
+                        sat_stats, options);
 }
 
 void fix_useless_green_blue_nodes(Graph& graph, GraphAttributes& attributes,
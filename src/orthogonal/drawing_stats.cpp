@@ -6,6 +6,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "core/graph/frozen_graph.hpp"
+
 float min_coordinate(
     std::unordered_map<int, std::unordered_set<int>> coordinate_to_nodes) {
   float min_c = MAXFLOAT;
@@ -14,17 +16,17 @@ float min_coordinate(
   return min_c;
 }
 
-auto compute_node_to_coordinates_integer(const Graph& graph,
+auto compute_node_to_coordinates_integer(const FrozenGraph& graph,
                                          const NodesPositions& positions) {
   std::unordered_map<int, std::unordered_set<int>> coordinate_y_to_nodes;
-  for (const auto& node : graph.get_nodes()) {
-    int node_id = node.get_id();
+  for (int node = 0; node < graph.size(); ++node) {
+    int node_id = graph.get_id(node);
     int y = std::round(100.0 * positions.get_position_y(node_id));
     coordinate_y_to_nodes[y].insert(node_id);
   }
   std::unordered_map<int, std::unordered_set<int>> coordinate_x_to_nodes;
-  for (const auto& node : graph.get_nodes()) {
-    int node_id = node.get_id();
+  for (int node = 0; node < graph.size(); ++node) {
+    int node_id = graph.get_id(node);
     int x = std::round(100.0 * positions.get_position_x(node_id));
     coordinate_x_to_nodes[x].insert(node_id);
   }
@@ -55,21 +57,22 @@ auto compute_node_to_coordinates_integer(const Graph& graph,
   return std::make_pair(node_to_coordinate_x, node_to_coordinate_y);
 }
 
-std::vector<int> compute_edge_lengths(const Graph& graph,
+std::vector<int> compute_edge_lengths(const FrozenGraph& graph,
                                       const GraphAttributes& attributes,
                                       const NodesPositions& positions) {
   auto [node_to_coordinate_x, node_to_coordinate_y] =
       compute_node_to_coordinates_integer(graph, positions);
   std::vector<int> edge_lengths;
-  std::unordered_set<int> visited;
-  for (const auto& node : graph.get_nodes()) {
-    if (attributes.get_node_color(node.get_id()) != Color::BLACK) continue;
-    std::function<void(int, int, int)> dfs = [&](int current_id, int black_id,
+  std::vector<bool> visited(graph.size(), false);
+  for (int node = 0; node < graph.size(); ++node) {
+    if (attributes.get_node_color(graph.get_id(node)) != Color::BLACK) continue;
+    std::function<void(int, int, int)> dfs = [&](int current, int black_id,
                                                  int current_length) {
-      visited.insert(current_id);
-      for (const auto& edge : graph.get_node_by_id(current_id).get_edges()) {
-        int neighbor = edge.get_to().get_id();
-        if (visited.contains(neighbor)) continue;
+      visited[current] = true;
+      int current_id = graph.get_id(current);
+      for (int neighbor_index : graph.get_neighbors(current)) {
+        if (visited[neighbor_index]) continue;
+        int neighbor = graph.get_id(neighbor_index);
         int x1 = node_to_coordinate_x[current_id];
         int y1 = node_to_coordinate_y[current_id];
         int x2 = node_to_coordinate_x[neighbor];
@@ -77,7 +80,7 @@ std::vector<int> compute_edge_lengths(const Graph& graph,
         int length = std::abs(x1 - x2) + std::abs(y1 - y2);
         Color neighbor_color = attributes.get_node_color(neighbor);
         if (neighbor_color != Color::BLACK)
-          dfs(neighbor, black_id, current_length + length);
+          dfs(neighbor_index, black_id, current_length + length);
         else {
           if (black_id < neighbor) {
             int total_length = current_length + length;
@@ -85,15 +88,15 @@ std::vector<int> compute_edge_lengths(const Graph& graph,
           }
         }
       }
-      visited.erase(current_id);
+      visited[current] = false;
     };
-    dfs(node.get_id(), node.get_id(), 0);
+    dfs(node, graph.get_id(node), 0);
   }
   return edge_lengths;
 }
 
 int compute_total_edge_length(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   std::vector<int> edge_lengths =
       compute_edge_lengths(graph, result.attributes, result.positions);
   int total_edge_length = 0;
@@ -102,7 +105,7 @@ int compute_total_edge_length(const DrawingResult& result) {
 }
 
 int compute_max_edge_length(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& attributes = result.attributes;
   std::vector<int> edge_lengths =
       compute_edge_lengths(graph, attributes, result.positions);
@@ -113,45 +116,48 @@ int compute_max_edge_length(const DrawingResult& result) {
 }
 
 double compute_edge_length_std_dev(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& attributes = result.attributes;
   std::vector<int> edge_lengths =
       compute_edge_lengths(graph, attributes, result.positions);
   return compute_stddev(edge_lengths);
 }
 
-std::vector<int> compute_bends_counts(const Graph& graph,
+std::vector<int> compute_bends_counts(const FrozenGraph& graph,
                                       const GraphAttributes& attributes) {
   std::vector<int> bends_counts;
-  for (const auto& node : graph.get_nodes()) {
-    if (attributes.get_node_color(node.get_id()) != Color::BLACK) continue;
-    std::unordered_set<int> visited;
+  std::vector<bool> visited(graph.size(), false);
+  for (int node = 0; node < graph.size(); ++node) {
+    if (attributes.get_node_color(graph.get_id(node)) != Color::BLACK) continue;
     std::function<void(int, int, int, int)> dfs =
         [&](int current, int black, int count, int previous_id) {
-          visited.insert(current);
-          for (const auto& edge : graph.get_node_by_id(current).get_edges()) {
-            int neighbor = edge.get_to().get_id();
-            if (visited.contains(neighbor)) continue;
+          visited[current] = true;
+          int current_id = graph.get_id(current);
+          for (int neighbor_index : graph.get_neighbors(current)) {
+            if (visited[neighbor_index]) continue;
+            int neighbor = graph.get_id(neighbor_index);
             Color neighbor_color = attributes.get_node_color(neighbor);
             if (neighbor_color != Color::BLACK) {
               if (attributes.are_nodes_identified(previous_id, neighbor))
-                dfs(neighbor, black, count, current);
+                dfs(neighbor_index, black, count, current_id);
               else
-                dfs(neighbor, black, count + 1, current);
+                dfs(neighbor_index, black, count + 1, current_id);
             } else if (black < neighbor) {
-              if (attributes.are_nodes_identified(current, neighbor)) count--;
+              if (attributes.are_nodes_identified(current_id, neighbor))
+                count--;
               bends_counts.push_back(count);
             }
           }
-          visited.erase(current);
+          visited[current] = false;
         };
-    dfs(node.get_id(), node.get_id(), 0, node.get_id());
+    int node_id = graph.get_id(node);
+    dfs(node, node_id, 0, node_id);
   }
   return bends_counts;
 }
 
 int compute_total_bends(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& attributes = result.attributes;
   std::vector<int> bends_counts = compute_bends_counts(graph, attributes);
   int total_bends = 0;
@@ -160,7 +166,7 @@ int compute_total_bends(const DrawingResult& result) {
 }
 
 int compute_max_bends_per_edge(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& attributes = result.attributes;
   std::vector<int> bends_counts = compute_bends_counts(graph, attributes);
   int max_bends = 0;
@@ -170,13 +176,13 @@ int compute_max_bends_per_edge(const DrawingResult& result) {
 }
 
 double compute_bends_std_dev(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& attributes = result.attributes;
   return compute_stddev(compute_bends_counts(graph, attributes));
 }
 
 int compute_total_area(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& positions = result.positions;
   auto [node_to_coordinate_x, node_to_coordinate_y] =
       compute_node_to_coordinates_integer(graph, positions);
@@ -184,8 +190,8 @@ int compute_total_area(const DrawingResult& result) {
   int max_y = -INT_MAX;
   int min_x = INT_MAX;
   int min_y = INT_MAX;
-  for (const auto& node : graph.get_nodes()) {
-    int node_id = node.get_id();
+  for (int node = 0; node < graph.size(); ++node) {
+    int node_id = graph.get_id(node);
     int x = node_to_coordinate_x[node_id];
     int y = node_to_coordinate_y[node_id];
     max_x = std::max(max_x, x);
@@ -274,23 +280,22 @@ bool do_edges_cross(const NodesPositions& positions, int i, int j, int k,
 }
 
 int compute_total_crossings(const DrawingResult& result) {
-  const auto& graph = *result.augmented_graph;
+  const FrozenGraph graph(*result.augmented_graph);
   const auto& positions = result.positions;
   const GraphAttributes& attributes = result.attributes;
   auto [node_to_coordinate_x, node_to_coordinate_y] =
       compute_node_to_coordinates_integer(graph, positions);
+  std::vector<std::pair<int, int>> edges;
+  edges.reserve(graph.get_number_of_edges() / 2);
+  for (int node = 0; node < graph.size(); ++node)
+    for (int neighbor : graph.get_neighbors(node))
+      if (graph.get_id(node) < graph.get_id(neighbor))
+        edges.push_back({graph.get_id(node), graph.get_id(neighbor)});
   int total_crossings = 0;
-  for (auto& edge : graph.get_edges()) {
-    int edge_id = edge.get_id();
-    int i = edge.get_from().get_id();
-    int j = edge.get_to().get_id();
-    if (i > j) continue;
-    for (auto& other_edge : graph.get_edges()) {
-      int other_edge_id = other_edge.get_id();
-      if (edge_id >= other_edge_id) continue;
-      int k = other_edge.get_from().get_id();
-      int l = other_edge.get_to().get_id();
-      if (k > l) continue;
+  for (int a = 0; a < edges.size(); ++a) {
+    auto [i, j] = edges[a];
+    for (int b = a + 1; b < edges.size(); ++b) {
+      auto [k, l] = edges[b];
       if (i == k || i == l || j == k || j == l) continue;
       if (do_edges_cross(positions, i, j, k, l)) ++total_crossings;
     }
@@ -27,7 +27,7 @@ int EquivalenceClasses::get_class_of_elem(int elem) const {
   return m_elem_to_class.at(elem);
 }
 
-const std::unordered_set<int>& EquivalenceClasses::get_elems_of_class(
+const std::pmr::unordered_set<int>& EquivalenceClasses::get_elems_of_class(
     int class_id) const {
   if (!has_class(class_id))
     throw std::runtime_error(
@@ -50,23 +50,22 @@ void EquivalenceClasses::print() const {
 }
 
 void directional_node_expander(
-    const Shape& shape, const Graph& graph, const GraphNode& node, int class_id,
+    const Shape& shape, const FrozenGraph& graph, int node, int class_id,
     EquivalenceClasses& equivalence_classes,
     std::function<bool(const Shape&, int, int)> is_direction_wrong) {
-  int node_id = node.get_id();
+  int node_id = graph.get_id(node);
   equivalence_classes.set_class(node_id, class_id);
-  for (auto& edge : node.get_edges()) {
-    int neighbor_id = edge.get_to().get_id();
+  for (int neighbor : graph.get_neighbors(node)) {
+    int neighbor_id = graph.get_id(neighbor);
     if (equivalence_classes.has_elem_a_class(neighbor_id)) continue;
     if (is_direction_wrong(shape, node_id, neighbor_id)) continue;
-    directional_node_expander(shape, graph, edge.get_to(), class_id,
+    directional_node_expander(shape, graph, neighbor, class_id,
                               equivalence_classes, is_direction_wrong);
   }
 }
 
-void horizontal_node_expander(const Shape& shape, const Graph& graph,
-                              const GraphNode& node, int class_id,
-                              GraphEdgeHashSet& is_edge_visited,
+void horizontal_node_expander(const Shape& shape, const FrozenGraph& graph,
+                              int node, int class_id,
                               EquivalenceClasses& equivalence_classes) {
   auto is_direction_wrong = [](const Shape& shape, int i, int j) {
     return shape.is_vertical(i, j);
@@ -75,9 +74,8 @@ void horizontal_node_expander(const Shape& shape, const Graph& graph,
                             is_direction_wrong);
 }
 
-void vertical_node_expander(const Shape& shape, const Graph& graph,
-                            const GraphNode& node, int class_id,
-                            GraphEdgeHashSet& is_edge_visited,
+void vertical_node_expander(const Shape& shape, const FrozenGraph& graph,
+                            int node, int class_id,
                             EquivalenceClasses& equivalence_classes) {
   auto is_direction_wrong = [](const Shape& shape, int i, int j) {
     return shape.is_horizontal(i, j);
@@ -87,25 +85,33 @@ void vertical_node_expander(const Shape& shape, const Graph& graph,
 }
 
 const std::pair<EquivalenceClasses, EquivalenceClasses>
-build_equivalence_classes(const Shape& shape, const Graph& graph) {
-  EquivalenceClasses equivalence_classes_x;
-  EquivalenceClasses equivalence_classes_y;
+build_equivalence_classes(const Shape& shape, const Graph& graph,
+                          std::pmr::memory_resource* resource) {
+  return build_equivalence_classes(shape, FrozenGraph(graph), resource);
+}
+
+const std::pair<EquivalenceClasses, EquivalenceClasses>
+build_equivalence_classes(const Shape& shape, const FrozenGraph& graph,
+                          std::pmr::memory_resource* resource) {
+  EquivalenceClasses equivalence_classes_x(resource);
+  EquivalenceClasses equivalence_classes_y(resource);
   int next_class_x = 0;
   int next_class_y = 0;
-  GraphEdgeHashSet is_edge_visited;
-  for (auto& node : graph.get_nodes()) {
-    if (!equivalence_classes_y.has_elem_a_class(node.get_id()))
+  for (int node = 0; node < graph.size(); ++node) {
+    int node_id = graph.get_id(node);
+    if (!equivalence_classes_y.has_elem_a_class(node_id))
       horizontal_node_expander(shape, graph, node, next_class_y++,
-                               is_edge_visited, equivalence_classes_y);
-    if (!equivalence_classes_x.has_elem_a_class(node.get_id()))
+                               equivalence_classes_y);
+    if (!equivalence_classes_x.has_elem_a_class(node_id))
       vertical_node_expander(shape, graph, node, next_class_x++,
-                             is_edge_visited, equivalence_classes_x);
+                             equivalence_classes_x);
   }
-  for (const auto& node : graph.get_nodes()) {
-    if (!equivalence_classes_x.has_elem_a_class(node.get_id()))
-      equivalence_classes_x.set_class(node.get_id(), next_class_x++);
-    if (!equivalence_classes_y.has_elem_a_class(node.get_id()))
-      equivalence_classes_y.set_class(node.get_id(), next_class_y++);
+  for (int node = 0; node < graph.size(); ++node) {
+    int node_id = graph.get_id(node);
+    if (!equivalence_classes_x.has_elem_a_class(node_id))
+      equivalence_classes_x.set_class(node_id, next_class_x++);
+    if (!equivalence_classes_y.has_elem_a_class(node_id))
+      equivalence_classes_y.set_class(node_id, next_class_y++);
   }
   return std::make_pair(std::move(equivalence_classes_x),
                         std::move(equivalence_classes_y));
@@ -115,15 +121,16 @@ std::tuple<std::unique_ptr<Graph>, std::unique_ptr<Graph>, GraphAttributes,
            GraphAttributes>
 equivalence_classes_to_ordering(const EquivalenceClasses& equivalence_classes_x,
                                 const EquivalenceClasses& equivalence_classes_y,
-                                const Graph& graph, const Shape& shape) {
-  auto ordering_x = std::make_unique<Graph>();
-  auto ordering_y = std::make_unique<Graph>();
+                                const Graph& graph, const Shape& shape,
+                                std::pmr::memory_resource* resource) {
+  auto ordering_x = std::make_unique<Graph>(resource);
+  auto ordering_y = std::make_unique<Graph>(resource);
   for (int class_id : equivalence_classes_x.get_all_classes())
     ordering_x->add_node(class_id);
   for (int class_id : equivalence_classes_y.get_all_classes())
     ordering_y->add_node(class_id);
-  GraphAttributes ordering_x_edge_to_graph_edge;
-  GraphAttributes ordering_y_edge_to_graph_edge;
+  GraphAttributes ordering_x_edge_to_graph_edge(resource);
+  GraphAttributes ordering_y_edge_to_graph_edge(resource);
   ordering_x_edge_to_graph_edge.add_attribute(Attribute::EDGES_ANY_LABEL);
   ordering_y_edge_to_graph_edge.add_attribute(Attribute::EDGES_ANY_LABEL);
   for (auto& node : graph.get_nodes()) {
@@ -1,5 +1,8 @@
 #include "orthogonal/shape/clauses_functions.hpp"
 
+#include <algorithm>
+#include <utility>
+
 void add_constraints_at_most_one_is_true(CnfBuilder& cnf_builder, int var_1,
                                          int var_2, int var_3, int var_4) {
   // at most one is true (at least three are false)
@@ -11,121 +14,181 @@ void add_constraints_at_most_one_is_true(CnfBuilder& cnf_builder, int var_1,
   cnf_builder.add_clause({-var_2, -var_4});
   cnf_builder.add_clause({-var_3, -var_4});
 }
-void add_constraints_one_direction_per_edge(const Graph& graph,
+void add_constraints_one_direction_for_edge(int i, int j,
                                             CnfBuilder& cnf_builder,
-                                            const VariablesHandler& handler,
-                                            int up, int down, int right,
-                                            int left) {
+                                            VariablesHandler& handler) {
+  // every assignment of the two bits of the compact encoding is a direction
+  if (handler.get_encoding() == DirectionEncoding::COMPACT) return;
+  int up = handler.get_up_variable(i, j);
+  int down = handler.get_down_variable(i, j);
+  int right = handler.get_right_variable(i, j);
+  int left = handler.get_left_variable(i, j);
   cnf_builder.add_clause({up, down, right, left});  // at least one is true
   add_constraints_at_most_one_is_true(cnf_builder, up, down, left, right);
 }
 
 void add_constraints_one_direction_per_edge(const Graph& graph,
                                             CnfBuilder& cnf_builder,
-                                            const VariablesHandler& handler) {
+                                            VariablesHandler& handler) {
   for (auto& node : graph.get_nodes()) {
     int i = node.get_id();
     for (auto& edge : node.get_edges()) {
       int j = edge.get_to().get_id();
       if (i > j) continue;
-      int up = handler.get_up_variable(i, j);
-      int down = handler.get_down_variable(i, j);
-      int right = handler.get_right_variable(i, j);
-      int left = handler.get_left_variable(i, j);
-      add_constraints_one_direction_per_edge(graph, cnf_builder, handler, up,
-                                             down, right, left);
+      add_constraints_one_direction_for_edge(i, j, cnf_builder, handler);
     }
   }
 }
 
 void add_clause_at_least_one_in_direction(CnfBuilder& cnf_builder,
-                                          const VariablesHandler& handler,
+                                          VariablesHandler& handler,
                                           const GraphNode& node,
                                           Direction direction) {
   std::vector<int> clause;
   int node_id = node.get_id();
   for (auto& edge : node.get_edges()) {
     int neighbor_id = edge.get_to().get_id();
-    clause.push_back(handler.get_variable(node_id, neighbor_id, direction));
+    clause.push_back(
+        handler.get_direction_literal(node_id, neighbor_id, direction));
   }
   cnf_builder.add_clause(clause);
 }
 
+void add_clauses_at_most_one_in_direction(CnfBuilder& cnf_builder,
+                                          const VariablesHandler& handler,
+                                          const GraphNode& node,
+                                          Direction direction) {
+  int i = node.get_id();
+  std::vector<std::vector<int>> literals;
+  for (auto& edge : node.get_edges())
+    literals.push_back(
+        handler.get_direction_literals(i, edge.get_to().get_id(), direction));
+  // for every possible pair, at least one is not in the direction
+  std::vector<int> clause;
+  for (int a = 0; a < literals.size(); a++)
+    for (int b = a + 1; b < literals.size(); b++) {
+      clause.clear();
+      for (int lit : literals[a]) clause.push_back(-lit);
+      for (int lit : literals[b]) clause.push_back(-lit);
+      cnf_builder.add_clause(clause);
+    }
+}
+
 void add_one_edge_per_direction_clauses(CnfBuilder& cnf_builder,
-                                        const VariablesHandler& handler,
+                                        VariablesHandler& handler,
                                         const Direction direction,
                                         const GraphNode& node) {
-  int i = node.get_id();
   int degree = node.get_degree();
-  if (degree == 4) {
-    add_clause_at_least_one_in_direction(cnf_builder, handler, node, direction);
-  } else if (degree == 3) {
-    std::vector<int> variables;
-    for (auto& edge : node.get_edges())
-      variables.push_back(
-          handler.get_variable(i, edge.get_to().get_id(), direction));
-    // at most one is true (at least 2 are false)
-    cnf_builder.add_clause({-variables[0], -variables[1]});
-    cnf_builder.add_clause({-variables[0], -variables[2]});
-    cnf_builder.add_clause({-variables[1], -variables[2]});
-  } else if (degree == 2) {
-    std::vector<int> clause;
-    for (auto& edge : node.get_edges())
-      clause.push_back(
-          -handler.get_variable(i, edge.get_to().get_id(), direction));
-    // at most one is true (at least 1 is false)
-    cnf_builder.add_clause(clause);
-  } else if (degree != 1) {
+  if (degree < 1 || degree > 4)
     throw std::runtime_error("degree of node is not valid");
+  // with 4 edges and 4 directions, at most one per direction already means
+  // exactly one, which needs no auxiliary literals in the compact encoding
+  if (degree == 4 && handler.get_encoding() == DirectionEncoding::ONE_HOT)
+    add_clause_at_least_one_in_direction(cnf_builder, handler, node, direction);
+  else if (degree > 1)
+    add_clauses_at_most_one_in_direction(cnf_builder, handler, node,
+                                         direction);
+}
+
+void add_cycle_constraints(CnfBuilder& cnf_builder,
+                           const std::vector<int>& cycle,
+                           VariablesHandler& handler) {
+  std::vector<int> at_least_one;
+  for (auto direction :
+       {Direction::DOWN, Direction::UP, Direction::RIGHT, Direction::LEFT}) {
+    at_least_one.clear();
+    for (int i = 0; i < cycle.size(); i++)
+      at_least_one.push_back(handler.get_direction_literal(
+          cycle[i], cycle[(i + 1) % cycle.size()], direction));
+    cnf_builder.add_clause(at_least_one);
   }
 }
 
 void add_cycles_constraints(const Graph& graph, CnfBuilder& cnf_builder,
                             const std::vector<std::vector<int>>& cycles,
-                            const VariablesHandler& handler) {
-  for (auto& cycle : cycles) {
-    auto at_least_one_down = std::vector<int>();
-    auto at_least_one_up = std::vector<int>();
-    auto at_least_one_right = std::vector<int>();
-    auto at_least_one_left = std::vector<int>();
-    for (int i = 0; i < cycle.size(); i++) {
-      at_least_one_down.push_back(
-          handler.get_down_variable(cycle[i], cycle[(i + 1) % cycle.size()]));
-      at_least_one_up.push_back(
-          handler.get_up_variable(cycle[i], cycle[(i + 1) % cycle.size()]));
-      at_least_one_right.push_back(
-          handler.get_right_variable(cycle[i], cycle[(i + 1) % cycle.size()]));
-      at_least_one_left.push_back(
-          handler.get_left_variable(cycle[i], cycle[(i + 1) % cycle.size()]));
-    }
-    cnf_builder.add_clause(at_least_one_down);
-    cnf_builder.add_clause(at_least_one_up);
-    cnf_builder.add_clause(at_least_one_right);
-    cnf_builder.add_clause(at_least_one_left);
+                            VariablesHandler& handler) {
+  for (auto& cycle : cycles) add_cycle_constraints(cnf_builder, cycle, handler);
+}
+
+void add_node_constraints(const GraphNode& node, CnfBuilder& cnf_builder,
+                          VariablesHandler& handler) {
+  if (node.get_degree() <= 4) {
+    add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::UP,
+                                       node);
+    add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::DOWN,
+                                       node);
+    add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::RIGHT,
+                                       node);
+    add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::LEFT,
+                                       node);
+  } else {
+    add_clause_at_least_one_in_direction(cnf_builder, handler, node,
+                                         Direction::UP);
+    add_clause_at_least_one_in_direction(cnf_builder, handler, node,
+                                         Direction::DOWN);
+    add_clause_at_least_one_in_direction(cnf_builder, handler, node,
+                                         Direction::RIGHT);
+    add_clause_at_least_one_in_direction(cnf_builder, handler, node,
+                                         Direction::LEFT);
   }
 }
 
 void add_nodes_constraints(const Graph& graph, CnfBuilder& cnf_builder,
-                           const VariablesHandler& handler) {
-  for (auto& node : graph.get_nodes()) {
-    if (node.get_degree() <= 4) {
-      add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::UP,
-                                         node);
-      add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::DOWN,
-                                         node);
-      add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::RIGHT,
-                                         node);
-      add_one_edge_per_direction_clauses(cnf_builder, handler, Direction::LEFT,
-                                         node);
-    } else {
-      add_clause_at_least_one_in_direction(cnf_builder, handler, node,
-                                           Direction::UP);
-      add_clause_at_least_one_in_direction(cnf_builder, handler, node,
-                                           Direction::DOWN);
-      add_clause_at_least_one_in_direction(cnf_builder, handler, node,
-                                           Direction::RIGHT);
-      add_clause_at_least_one_in_direction(cnf_builder, handler, node,
-                                           Direction::LEFT);
+                           VariablesHandler& handler) {
+  for (auto& node : graph.get_nodes())
+    add_node_constraints(node, cnf_builder, handler);
+}
+
+void add_forbidden_directions_clauses(const GraphNode& node, int directions,
+                                      CnfBuilder& cnf_builder,
+                                      const VariablesHandler& handler) {
+  std::vector<int> clause;
+  for (auto direction : get_all_directions()) {
+    if (!(directions & (1 << static_cast<int>(direction)))) continue;
+    for (auto& edge : node.get_edges()) {
+      clause.clear();
+      for (int lit : handler.get_direction_literals(
+               node.get_id(), edge.get_to().get_id(), direction))
+        clause.push_back(-lit);
+      cnf_builder.add_clause(clause);
     }
   }
-}
\ No newline at end of file
+}
+
+std::optional<std::pair<int, int>> add_symmetry_breaking_clauses(
+    const Graph& graph, CnfBuilder& cnf_builder,
+    const VariablesHandler& handler) {
+  // ties are broken by id, so that the same graph gets the same clauses
+  const GraphNode* reference = nullptr;
+  for (auto& node : graph.get_nodes())
+    if (reference == nullptr || node.get_degree() > reference->get_degree() ||
+        (node.get_degree() == reference->get_degree() &&
+         node.get_id() < reference->get_id()))
+      reference = &node;
+  if (reference == nullptr) return std::nullopt;
+  return add_symmetry_breaking_clauses_at_node(*reference, cnf_builder,
+                                               handler);
+}
+
+std::optional<std::pair<int, int>> add_symmetry_breaking_clauses_at_node(
+    const GraphNode& node, CnfBuilder& cnf_builder,
+    const VariablesHandler& handler) {
+  if (node.get_degree() == 0) return std::nullopt;
+  int i = node.get_id();
+  std::vector<int> neighbors;
+  for (auto& edge : node.get_edges())
+    neighbors.push_back(edge.get_to().get_id());
+  std::sort(neighbors.begin(), neighbors.end());
+  // rotations
+  for (int lit : handler.get_direction_literals(i, neighbors[0],
+                                                Direction::RIGHT))
+    cnf_builder.add_clause({lit});
+  if (neighbors.size() < 2) return std::make_pair(i, neighbors[0]);
+  // the mirror image along the horizontal axis
+  std::vector<int> clause;
+  for (int lit :
+       handler.get_direction_literals(i, neighbors[1], Direction::DOWN))
+    clause.push_back(-lit);
+  cnf_builder.add_clause(clause);
+  return std::make_pair(i, neighbors[0]);
+}
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "core/tree/tree.hpp"
 #include "core/tree/tree_algorithms.hpp"
@@ -16,6 +17,8 @@
 #include "orthogonal/shape/variables_handler.hpp"
 #include "sat/cnf_builder.hpp"
 #include "sat/glucose.hpp"
+#include "sat/sat_solver.hpp"
+#include "sat/totalizer.hpp"
 
 const std::string unit_clauses_logs_file = "unit_clauses_logs.txt";
 std::mutex unit_clauses_logs_mutex;
@@ -40,9 +43,59 @@ Shape result_to_shape(const Graph& graph, const std::vector<int>& numbers,
   return std::move(shape);
 }
 
-std::pair<int, int> find_edges_to_split(
+// literals that make the edges of graph go as in shape, edges missing from
+// shape get none
+std::vector<int> shape_to_phase_hints(const Graph& graph, const Shape& shape,
+                                      const VariablesHandler& handler) {
+  std::vector<int> hints;
+  for (const auto& node : graph.get_nodes()) {
+    int i = node.get_id();
+    for (auto& edge : node.get_edges()) {
+      int j = edge.get_to().get_id();
+      if (i > j || !shape.contains(i, j)) continue;
+      Direction direction = shape.get_direction(i, j);
+      for (int lit : handler.get_direction_literals(i, j, direction))
+        hints.push_back(lit);
+      if (handler.get_encoding() != DirectionEncoding::ONE_HOT) continue;
+      for (auto other : get_all_directions())
+        if (other != direction)
+          hints.push_back(-handler.get_variable(i, j, other));
+    }
+  }
+  return hints;
+}
+
+// both halves of a split edge go the way the edge went
+void split_shape_edge(Shape& shape, int from_id, int corner_id, int to_id) {
+  if (!shape.contains(from_id, to_id)) return;
+  Direction direction = shape.get_direction(from_id, to_id);
+  shape.set_direction(from_id, corner_id, direction);
+  shape.set_direction(corner_id, from_id, opposite_direction(direction));
+  shape.set_direction(corner_id, to_id, direction);
+  shape.set_direction(to_id, corner_id, opposite_direction(direction));
+}
+
+// finds the corners added to graph since shape was built, as the nodes of
+// degree 2 that shape does not know, and gives their edges a direction
+void carry_shape_over_splits(const Graph& graph, Shape& shape) {
+  for (const auto& node : graph.get_nodes()) {
+    if (node.get_degree() != 2) continue;
+    int corner_id = node.get_id();
+    std::vector<int> neighbors;
+    for (auto& edge : node.get_edges())
+      neighbors.push_back(edge.get_to().get_id());
+    if (shape.contains(corner_id, neighbors[0]) ||
+        shape.contains(corner_id, neighbors[1]))
+      continue;
+    split_shape_edge(shape, neighbors[0], corner_id, neighbors[1]);
+  }
+}
+
+// the edges are distinct and never more than max_edges, which when 0 means
+// one edge for every unit clause of the proof
+std::vector<std::pair<int, int>> find_edges_to_split(
     const std::vector<std::string>& proof_lines, std::mt19937& random_engine,
-    const VariablesHandler& handler, const Graph& graph) {
+    const VariablesHandler& handler, const Graph& graph, int max_edges) {
   std::vector<int> unit_clauses;
   for (int i = proof_lines.size() - 1; i >= 0; i--) {
     const std::string& line = proof_lines[i];
@@ -65,39 +118,190 @@ std::pair<int, int> find_edges_to_split(
     for (auto line : proof_lines) std::cout << line << "\n";
     throw std::runtime_error("Could not find the edge to remove");
   }
-  // pick one of the first two unit clauses
-  int random_index = random_engine() % std::min((int)unit_clauses.size(), 2);
-  int variable = std::abs(unit_clauses[random_index]);
-  std::lock_guard<std::mutex> lock(unit_clauses_logs_mutex);
-  std::ofstream log_file(unit_clauses_logs_file, std::ios_base::app);
-  if (log_file) {
-    log_file << "units " << unit_clauses.size() << "\n";
-    log_file.close();
-  } else {
-    throw std::runtime_error("Error: Could not open log file for writing: " +
-                             unit_clauses_logs_file);
+  {
+    std::lock_guard<std::mutex> lock(unit_clauses_logs_mutex);
+    std::ofstream log_file(unit_clauses_logs_file, std::ios_base::app);
+    if (log_file) {
+      log_file << "units " << unit_clauses.size() << "\n";
+      log_file.close();
+    } else {
+      throw std::runtime_error("Error: Could not open log file for writing: " +
+                               unit_clauses_logs_file);
+    }
+  }
+  if (max_edges == 1) {
+    // pick one of the first two unit clauses
+    int random_index = random_engine() % std::min((int)unit_clauses.size(), 2);
+    int variable = std::abs(unit_clauses[random_index]);
+    return {handler.get_edge_of_variable(variable)};
+  }
+  // the last unit clauses of the proof are the closest to the conflict
+  std::vector<std::pair<int, int>> edges;
+  for (int literal : unit_clauses) {
+    auto [i, j] = handler.get_edge_of_variable(std::abs(literal));
+    std::pair<int, int> edge = {std::min(i, j), std::max(i, j)};
+    if (std::find(edges.begin(), edges.end(), edge) != edges.end()) continue;
+    edges.push_back(edge);
+    if (static_cast<int>(edges.size()) == max_edges) break;
   }
-  return handler.get_edge_of_variable(variable);
+  return edges;
 }
 
+std::unique_ptr<SatSolver> make_shape_solver(const ShapeOptions& options,
+                                             bool with_proof) {
+  auto solver =
+      make_sat_solver(options.sat_backend, with_proof, options.portfolio_size);
+  solver->set_conflict_budget(options.conflicts_per_solve);
+  solver->set_time_budget(options.seconds_per_solve);
+  return solver;
+}
+
+bool breaks_symmetries(const ShapeOptions& options) {
+  return options.break_symmetries && options.forbidden_directions.empty();
+}
+
+void add_forbidden_directions(const Graph& graph, const ShapeOptions& options,
+                              CnfBuilder& cnf_builder,
+                              const VariablesHandler& handler) {
+  for (auto [node_id, directions] : options.forbidden_directions)
+    if (graph.has_node(node_id))
+      add_forbidden_directions_clauses(graph.get_node_by_id(node_id),
+                                       directions, cnf_builder, handler);
+}
+
+bool uses_incremental_builder(const ShapeOptions& options) {
+  // the bend search builds its own formula with a corner on every edge
+  if (options.incremental && options.minimize_bends)
+    throw std::invalid_argument(
+        "ShapeOptions: incremental and minimize_bends cannot be combined");
+  return options.incremental &&
+         reports_failed_assumptions(options.sat_backend);
+}
+
+bool is_drawing_budget_exhausted(const ShapeOptions& options,
+                                 double solve_time) {
+  return options.seconds_per_drawing > 0.0 &&
+         solve_time >= options.seconds_per_drawing;
+}
+
+// seconds_per_solve cut to what is left of seconds_per_drawing after
+// solve_time seconds, 0 for no limit
+double get_solve_time_budget(double seconds_per_solve,
+                             double seconds_per_drawing, double solve_time) {
+  if (seconds_per_drawing <= 0.0) return seconds_per_solve;
+  double left = std::max(seconds_per_drawing - solve_time, 0.0);
+  return (seconds_per_solve > 0.0) ? std::min(seconds_per_solve, left) : left;
+}
+
+// phases, if given, are the directions the solver tries first
 std::optional<Shape> build_shape_or_add_corner(
     Graph& graph, GraphAttributes& attributes,
-    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine);
+    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine,
+    const ShapeOptions& options, SatStats& sat_stats, CnfBuilder& cnf_builder,
+    const Shape* phases);
+
+std::optional<Shape> build_shape_or_add_corner_from_core(
+    Graph& graph, GraphAttributes& attributes,
+    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine,
+    const ShapeOptions& options, SatStats& sat_stats, CnfBuilder& cnf_builder,
+    const Shape* phases);
+
+std::optional<Shape> build_shape_with_fewest_corners(
+    Graph& graph, GraphAttributes& attributes,
+    std::vector<std::vector<int>>& cycles, const ShapeOptions& options,
+    SatStats& sat_stats, CnfBuilder& cnf_builder, const Shape* phases);
 
 Shape build_shape(Graph& graph, GraphAttributes& attributes,
-                  std::vector<std::vector<int>>& cycles, bool randomize) {
-  int seed = (randomize) ? std::random_device{}() : 42;
+                  std::vector<std::vector<int>>& cycles,
+                  const ShapeOptions& options, SatStats* sat_stats,
+                  const Shape* initial_phases) {
+  // the solves of the previous calls for the same drawing count as well
+  const double previous_solve_time =
+      (sat_stats != nullptr) ? sat_stats->solve_time : 0.0;
+  if (is_drawing_budget_exhausted(options, previous_solve_time))
+    throw DrawingBudgetExhausted();
+  // what is left of the drawing's budget is the budget of this call
+  ShapeOptions round_options = options;
+  if (options.seconds_per_drawing > 0.0)
+    round_options.seconds_per_drawing -= previous_solve_time;
+  if (uses_incremental_builder(options)) {
+    IncrementalShapeBuilder builder(graph, attributes, cycles, round_options);
+    if (initial_phases != nullptr) builder.set_phases(*initial_phases);
+    Shape shape = builder.build_shape();
+    if (sat_stats != nullptr) sat_stats->add(builder.get_sat_stats());
+    return shape;
+  }
+  int seed = (options.randomize) ? std::random_device{}() : 42;
   std::mt19937 random_engine(seed);
-  auto shape =
-      build_shape_or_add_corner(graph, attributes, cycles, random_engine);
-  while (!shape.has_value())
-    shape = build_shape_or_add_corner(graph, attributes, cycles, random_engine);
+  SatStats stats;
+  // before every attempt, so that no solve runs past the drawing's budget
+  auto update_round_options = [&]() {
+    const double solve_time = previous_solve_time + stats.solve_time;
+    if (is_drawing_budget_exhausted(options, solve_time))
+      throw DrawingBudgetExhausted();
+    round_options.seconds_per_solve = get_solve_time_budget(
+        options.seconds_per_solve, options.seconds_per_drawing, solve_time);
+    if (options.seconds_per_drawing > 0.0)
+      round_options.seconds_per_drawing =
+          options.seconds_per_drawing - solve_time;
+  };
+  // reused by every attempt, so its buffers are allocated only once
+  CnfBuilder cnf_builder;
+  std::optional<Shape> phases;
+  if (initial_phases != nullptr) phases = *initial_phases;
+  // the edges split by the previous attempt get the direction they had
+  auto get_phases = [&]() -> const Shape* {
+    if (!phases.has_value()) return nullptr;
+    carry_shape_over_splits(graph, *phases);
+    return &phases.value();
+  };
+  auto build = (options.split_from_proof ||
+                !reports_failed_assumptions(options.sat_backend))
+                   ? build_shape_or_add_corner
+                   : build_shape_or_add_corner_from_core;
+  if (options.minimize_bends) {
+    update_round_options();
+    auto shape = build_shape_with_fewest_corners(graph, attributes, cycles,
+                                                 round_options, stats,
+                                                 cnf_builder, get_phases());
+    // one corner per edge is not enough, an edge is split for good
+    while (!shape.has_value()) {
+      update_round_options();
+      build(graph, attributes, cycles, random_engine, round_options, stats,
+            cnf_builder, get_phases());
+      update_round_options();
+      shape = build_shape_with_fewest_corners(graph, attributes, cycles,
+                                              round_options, stats,
+                                              cnf_builder, get_phases());
+    }
+    if (sat_stats != nullptr) sat_stats->add(stats);
+    return std::move(shape.value());
+  }
+  update_round_options();
+  auto shape = build(graph, attributes, cycles, random_engine, round_options,
+                     stats, cnf_builder, get_phases());
+  while (!shape.has_value()) {
+    update_round_options();
+    shape = build(graph, attributes, cycles, random_engine, round_options,
+                  stats, cnf_builder, get_phases());
+  }
+  if (sat_stats != nullptr) sat_stats->add(stats);
   return std::move(shape.value());
 }
 
-void add_corner_inside_edge(int from_id, int to_id, Graph& graph,
-                            GraphAttributes& attributes,
-                            std::vector<std::vector<int>>& cycles) {
+void add_guarded_clauses(SatSolver& solver, const CnfBuilder& cnf_builder,
+                         int selector) {
+  std::vector<int> guarded_clause;
+  cnf_builder.for_each_clause([&](std::span<const int> clause) {
+    guarded_clause.assign(clause.begin(), clause.end());
+    guarded_clause.push_back(-selector);
+    solver.add_clause(guarded_clause);
+  });
+}
+
+int add_corner_inside_edge(int from_id, int to_id, Graph& graph,
+                           GraphAttributes& attributes,
+                           std::vector<std::vector<int>>& cycles) {
   int new_node_id = graph.add_node().get_id();
   attributes.set_node_color(new_node_id, Color::RED);
   graph.remove_undirected_edge(from_id, to_id);
@@ -115,29 +319,497 @@ void add_corner_inside_edge(int from_id, int to_id, Graph& graph,
       }
     }
   }
+  return new_node_id;
+}
+
+// an UNKNOWN answer has no core or proof to pick the edges from, they are
+// taken at random from the newest cycles, the ones the metrics checks just
+// added or else the last of the basis; at most max_edges of them, 0 for all
+// the edges of the newest cycle
+std::vector<std::pair<int, int>> choose_edges_after_unknown(
+    const Graph& graph, const std::vector<std::vector<int>>& cycles,
+    std::mt19937& random_engine, int max_edges) {
+  std::vector<std::pair<int, int>> edges;
+  std::vector<std::pair<int, int>> cycle_edges;
+  for (int c = static_cast<int>(cycles.size()) - 1; c >= 0; c--) {
+    const auto& cycle = cycles[c];
+    cycle_edges.clear();
+    for (int k = 0; k < static_cast<int>(cycle.size()); k++) {
+      int i = cycle[k];
+      int j = cycle[(k + 1) % cycle.size()];
+      std::pair<int, int> edge = {std::min(i, j), std::max(i, j)};
+      if (std::find(edges.begin(), edges.end(), edge) == edges.end())
+        cycle_edges.push_back(edge);
+    }
+    std::shuffle(cycle_edges.begin(), cycle_edges.end(), random_engine);
+    edges.insert(edges.end(), cycle_edges.begin(), cycle_edges.end());
+    if (max_edges == 0 || static_cast<int>(edges.size()) >= max_edges) break;
+  }
+  // without cycles any edge can take the corner
+  if (edges.empty()) {
+    for (auto& node : graph.get_nodes())
+      for (auto& edge : node.get_edges())
+        if (node.get_id() < edge.get_to().get_id())
+          edges.push_back({node.get_id(), edge.get_to().get_id()});
+    std::shuffle(edges.begin(), edges.end(), random_engine);
+    max_edges = std::max(max_edges, 1);
+  }
+  if (max_edges > 0 && static_cast<int>(edges.size()) > max_edges)
+    edges.resize(max_edges);
+  return edges;
+}
+
+void remove_corner_inside_edge(int from_id, int corner_id, int to_id,
+                               Graph& graph, GraphAttributes& attributes,
+                               std::vector<std::vector<int>>& cycles) {
+  graph.remove_node(corner_id);
+  attributes.remove_nodes_attribute(corner_id);
+  graph.add_undirected_edge(from_id, to_id);
+  for (auto& cycle : cycles) std::erase(cycle, corner_id);
 }
 
 std::optional<Shape> build_shape_or_add_corner(
     Graph& graph, GraphAttributes& attributes,
-    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine) {
-  VariablesHandler handler(graph);
-  CnfBuilder cnf_builder;
+    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine,
+    const ShapeOptions& options, SatStats& sat_stats, CnfBuilder& cnf_builder,
+    const Shape* phases) {
+  VariablesHandler handler(graph, options.direction_encoding);
+  cnf_builder.clear();
   cnf_builder.add_comment("constraints one direction per edge");
   add_constraints_one_direction_per_edge(graph, cnf_builder, handler);
   cnf_builder.add_comment("constraints nodes");
   add_nodes_constraints(graph, cnf_builder, handler);
+  add_forbidden_directions(graph, options, cnf_builder, handler);
   cnf_builder.add_comment("constraints cycles");
   add_cycles_constraints(graph, cnf_builder, cycles, handler);
-  const std::string cnf = get_unique_filename("cnf");
-  cnf_builder.convert_to_cnf(cnf);
-  auto results = launch_glucose(cnf, false);
-  remove(cnf.c_str());
+  if (breaks_symmetries(options)) {
+    cnf_builder.add_comment("symmetry breaking");
+    add_symmetry_breaking_clauses(graph, cnf_builder, handler);
+  }
+  for (auto& definition : handler.take_new_definitions())
+    cnf_builder.add_clause(definition.clause);
+  auto solver = make_shape_solver(options, true);
+  solver->add_clauses(cnf_builder);
+  if (phases != nullptr)
+    solver->set_phase_hints(shape_to_phase_hints(graph, *phases, handler));
+  auto results = solver->solve();
+  sat_stats.add(solver->get_stats());
+  if (results.result == GlucoseResultType::UNKNOWN) {
+    for (auto [from_id, to_id] : choose_edges_after_unknown(
+             graph, cycles, random_engine, options.corners_per_round))
+      add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+    return std::nullopt;
+  }
   if (results.result == GlucoseResultType::UNSAT) {
-    auto edge =
-        find_edges_to_split(results.proof_lines, random_engine, handler, graph);
-    add_corner_inside_edge(edge.first, edge.second, graph, attributes, cycles);
+    auto edges = find_edges_to_split(results.proof_lines, random_engine,
+                                     handler, graph, options.corners_per_round);
+    for (auto [from_id, to_id] : edges)
+      add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
     return std::nullopt;
   }
   const std::vector<int>& variables = results.numbers;
   return result_to_shape(graph, variables, handler);
-}
\ No newline at end of file
+}
+
+// the direction clauses of every edge are guarded by an assumption, the
+// edges to split are taken at random among the ones whose assumption is in
+// the UNSAT core
+std::optional<Shape> build_shape_or_add_corner_from_core(
+    Graph& graph, GraphAttributes& attributes,
+    std::vector<std::vector<int>>& cycles, std::mt19937& random_engine,
+    const ShapeOptions& options, SatStats& sat_stats, CnfBuilder& cnf_builder,
+    const Shape* phases) {
+  VariablesHandler handler(graph, options.direction_encoding);
+  cnf_builder.clear();
+  add_nodes_constraints(graph, cnf_builder, handler);
+  add_forbidden_directions(graph, options, cnf_builder, handler);
+  add_cycles_constraints(graph, cnf_builder, cycles, handler);
+  auto solver = make_shape_solver(options, false);
+  solver->add_clauses(cnf_builder);
+  // guarded like the direction clauses of the edge going right, otherwise
+  // they could make the unguarded clauses UNSAT on their own
+  CnfBuilder symmetry_clauses;
+  std::optional<std::pair<int, int>> reference_edge;
+  if (breaks_symmetries(options))
+    reference_edge =
+        add_symmetry_breaking_clauses(graph, symmetry_clauses, handler);
+  std::vector<int> assumptions;
+  std::unordered_map<int, std::pair<int, int>> assumption_to_edge;
+  for (auto& node : graph.get_nodes()) {
+    int i = node.get_id();
+    for (auto& edge : node.get_edges()) {
+      int j = edge.get_to().get_id();
+      if (i > j) continue;
+      int selector = handler.add_auxiliary_variable();
+      cnf_builder.clear();
+      add_constraints_one_direction_for_edge(i, j, cnf_builder, handler);
+      add_guarded_clauses(*solver, cnf_builder, selector);
+      if (reference_edge.has_value() &&
+          (*reference_edge == std::make_pair(i, j) ||
+           *reference_edge == std::make_pair(j, i)))
+        add_guarded_clauses(*solver, symmetry_clauses, selector);
+      assumptions.push_back(selector);
+      assumption_to_edge[selector] = {i, j};
+    }
+  }
+  // they only define the literals of the compact encoding, so they can never
+  // be part of a core and need no selector
+  for (auto& definition : handler.take_new_definitions())
+    solver->add_clause(definition.clause);
+  if (phases != nullptr)
+    solver->set_phase_hints(shape_to_phase_hints(graph, *phases, handler));
+  auto results = solver->solve(assumptions);
+  sat_stats.add(solver->get_stats());
+  if (results.result == GlucoseResultType::UNKNOWN) {
+    for (auto [from_id, to_id] : choose_edges_after_unknown(
+             graph, cycles, random_engine, options.corners_per_round))
+      add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+    return std::nullopt;
+  }
+  if (results.result == GlucoseResultType::UNSAT) {
+    const auto& core = results.failed_assumptions;
+    if (core.empty())
+      throw std::runtime_error(
+          "build_shape_or_add_corner_from_core: empty UNSAT core");
+    std::vector<int> selectors = core;
+    std::shuffle(selectors.begin(), selectors.end(), random_engine);
+    if (options.corners_per_round > 0 &&
+        static_cast<int>(selectors.size()) > options.corners_per_round)
+      selectors.resize(options.corners_per_round);
+    for (int selector : selectors) {
+      auto [from_id, to_id] = assumption_to_edge.at(selector);
+      add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+    }
+    return std::nullopt;
+  }
+  return result_to_shape(graph, results.numbers, handler);
+}
+
+struct CornerSlot {
+  int from_id;
+  int corner_id;
+  int to_id;
+  // false forces the edge to go straight through the corner
+  int corner_variable;
+};
+
+int count_corners(const std::vector<CornerSlot>& slots, const Shape& shape) {
+  int corners = 0;
+  for (const auto& slot : slots)
+    if (shape.get_direction(slot.from_id, slot.corner_id) !=
+        shape.get_direction(slot.corner_id, slot.to_id))
+      corners++;
+  return corners;
+}
+
+// every edge gets a corner node, the soft clauses ask each of them to be
+// straight and the number of bent ones is bounded with a totalizer, straight
+// corners are then removed from the graph
+std::optional<Shape> build_shape_with_fewest_corners(
+    Graph& graph, GraphAttributes& attributes,
+    std::vector<std::vector<int>>& cycles, const ShapeOptions& options,
+    SatStats& sat_stats, CnfBuilder& cnf_builder, const Shape* phases) {
+  std::vector<std::pair<int, int>> edges;
+  for (auto& node : graph.get_nodes()) {
+    int i = node.get_id();
+    for (auto& edge : node.get_edges())
+      if (i < edge.get_to().get_id()) edges.push_back({i, edge.get_to().get_id()});
+  }
+  std::vector<CornerSlot> slots;
+  for (auto [from_id, to_id] : edges) {
+    int corner_id =
+        add_corner_inside_edge(from_id, to_id, graph, attributes, cycles);
+    slots.push_back({from_id, corner_id, to_id, 0});
+  }
+  VariablesHandler handler(graph, options.direction_encoding);
+  cnf_builder.clear();
+  add_constraints_one_direction_per_edge(graph, cnf_builder, handler);
+  add_nodes_constraints(graph, cnf_builder, handler);
+  add_forbidden_directions(graph, options, cnf_builder, handler);
+  add_cycles_constraints(graph, cnf_builder, cycles, handler);
+  if (breaks_symmetries(options))
+    add_symmetry_breaking_clauses(graph, cnf_builder, handler);
+  for (auto& definition : handler.take_new_definitions())
+    cnf_builder.add_clause(definition.clause);
+  auto solver = make_shape_solver(options, false);
+  solver->add_clauses(cnf_builder);
+  std::vector<int> corner_variables;
+  std::vector<int> clause;
+  for (auto& slot : slots) {
+    slot.corner_variable = handler.add_auxiliary_variable();
+    corner_variables.push_back(slot.corner_variable);
+    for (auto direction : get_all_directions()) {
+      auto before =
+          handler.get_direction_literals(slot.from_id, slot.corner_id, direction);
+      for (int lit :
+           handler.get_direction_literals(slot.corner_id, slot.to_id, direction)) {
+        clause.clear();
+        for (int before_lit : before) clause.push_back(-before_lit);
+        clause.push_back(lit);
+        clause.push_back(slot.corner_variable);
+        solver->add_clause(clause);
+      }
+    }
+  }
+  // the phases make every corner straight, so the first model has few of them
+  std::vector<int> phase_hints;
+  if (phases != nullptr)
+    phase_hints = shape_to_phase_hints(graph, *phases, handler);
+  for (int variable : corner_variables) phase_hints.push_back(-variable);
+  solver->set_phase_hints(phase_hints);
+  auto results = solver->solve();
+  // out of budget, the caller splits edges as for an UNSAT
+  if (results.result != GlucoseResultType::SAT) {
+    sat_stats.add(solver->get_stats());
+    for (const auto& slot : slots)
+      remove_corner_inside_edge(slot.from_id, slot.corner_id, slot.to_id,
+                                graph, attributes, cycles);
+    return std::nullopt;
+  }
+  Shape shape = result_to_shape(graph, results.numbers, handler);
+  int corners = count_corners(slots, shape);
+  auto at_least = add_totalizer(*solver, corner_variables, corners, [&]() {
+    return handler.add_auxiliary_variable();
+  });
+  // binary search, the first model is usually far from the optimum; only an
+  // UNSAT raises the lower bound, an UNKNOWN proves nothing, so the search
+  // stops there with the best shape found so far
+  int lower_bound = 0;
+  bool is_proven_optimal = true;
+  while (lower_bound < corners) {
+    // options.seconds_per_drawing is what was left of it for this call
+    const double solve_time = solver->get_stats().solve_time;
+    if (is_drawing_budget_exhausted(options, solve_time)) {
+      is_proven_optimal = false;
+      break;
+    }
+    solver->set_time_budget(get_solve_time_budget(
+        options.seconds_per_solve, options.seconds_per_drawing, solve_time));
+    int middle = (lower_bound + corners) / 2;
+    results = solver->solve({-at_least[middle]});
+    if (results.result == GlucoseResultType::UNKNOWN) {
+      is_proven_optimal = false;
+      break;
+    }
+    if (results.result == GlucoseResultType::UNSAT) {
+      lower_bound = middle + 1;
+      continue;
+    }
+    handler.reset_variables_values();
+    shape = result_to_shape(graph, results.numbers, handler);
+    corners = count_corners(slots, shape);
+  }
+  sat_stats.add(solver->get_stats());
+  if (!is_proven_optimal) sat_stats.number_of_unproven_optima++;
+  for (const auto& slot : slots) {
+    Direction direction = shape.get_direction(slot.from_id, slot.corner_id);
+    if (direction != shape.get_direction(slot.corner_id, slot.to_id)) continue;
+    remove_corner_inside_edge(slot.from_id, slot.corner_id, slot.to_id, graph,
+                              attributes, cycles);
+    shape.remove_direction(slot.from_id, slot.corner_id);
+    shape.remove_direction(slot.corner_id, slot.from_id);
+    shape.remove_direction(slot.corner_id, slot.to_id);
+    shape.remove_direction(slot.to_id, slot.corner_id);
+    shape.set_direction(slot.from_id, slot.to_id, direction);
+    shape.set_direction(slot.to_id, slot.from_id,
+                        opposite_direction(direction));
+  }
+  return shape;
+}
+
+IncrementalShapeBuilder::IncrementalShapeBuilder(
+    Graph& graph, GraphAttributes& attributes,
+    std::vector<std::vector<int>>& cycles, const ShapeOptions& options)
+    : m_graph(graph),
+      m_attributes(attributes),
+      m_cycles(cycles),
+      m_random_engine((options.randomize) ? std::random_device{}() : 42),
+      m_corners_per_round(options.corners_per_round),
+      m_seconds_per_solve(options.seconds_per_solve),
+      m_seconds_per_drawing(options.seconds_per_drawing),
+      m_solver(make_shape_solver(options, false)),
+      m_handler(graph, options.direction_encoding),
+      m_forbidden_directions(options.forbidden_directions) {
+  // the failed assumptions of the other backends are all of them
+  if (!reports_failed_assumptions(options.sat_backend))
+    throw std::invalid_argument(
+        "IncrementalShapeBuilder: the sat backend does not report UNSAT "
+        "cores");
+  if (breaks_symmetries(options)) {
+    auto reference_edge =
+        add_symmetry_breaking_clauses(graph, m_cnf_builder, m_handler);
+    if (reference_edge.has_value()) m_symmetry_node = reference_edge->first;
+    m_cnf_builder.clear();
+  }
+  add_constraints_one_direction_per_edge(graph, m_cnf_builder, m_handler);
+  m_solver->add_clauses(m_cnf_builder);
+  for (int node_id : graph.get_nodes_ids()) add_node_clauses(node_id);
+  for (int i = 0; i < cycles.size(); i++) add_cycle_clauses(i);
+}
+
+void IncrementalShapeBuilder::add_node_clauses(int node_id) {
+  int selector = m_handler.add_auxiliary_variable();
+  m_cnf_builder.clear();
+  add_node_constraints(m_graph.get_node_by_id(node_id), m_cnf_builder,
+                       m_handler);
+  // guarded with the node, so that they are retired and stated again on its
+  // new edges when one of its edges is split, and never fail without a core
+  if (m_symmetry_node == node_id)
+    add_symmetry_breaking_clauses_at_node(m_graph.get_node_by_id(node_id),
+                                          m_cnf_builder, m_handler);
+  if (m_forbidden_directions.contains(node_id))
+    add_forbidden_directions_clauses(m_graph.get_node_by_id(node_id),
+                                     m_forbidden_directions.at(node_id),
+                                     m_cnf_builder, m_handler);
+  add_guarded_clauses(*m_solver, m_cnf_builder, selector);
+  add_new_definitions();
+  m_node_to_selector[node_id] = selector;
+  m_selector_to_node[selector] = node_id;
+}
+
+void IncrementalShapeBuilder::add_cycle_clauses(int cycle_index) {
+  int selector = m_handler.add_auxiliary_variable();
+  m_cnf_builder.clear();
+  add_cycle_constraints(m_cnf_builder, m_cycles[cycle_index], m_handler);
+  add_guarded_clauses(*m_solver, m_cnf_builder, selector);
+  add_new_definitions();
+  if (cycle_index == m_cycle_to_selector.size())
+    m_cycle_to_selector.push_back(selector);
+  else
+    m_cycle_to_selector[cycle_index] = selector;
+  m_selector_to_cycle[selector] = cycle_index;
+}
+
+void IncrementalShapeBuilder::add_new_definitions() {
+  for (auto& definition : m_handler.take_new_definitions())
+    m_solver->add_clause(definition.clause);
+}
+
+void IncrementalShapeBuilder::retire_selector(int selector) {
+  m_solver->add_clause({-selector});
+  m_selector_to_node.erase(selector);
+  m_selector_to_cycle.erase(selector);
+}
+
+void IncrementalShapeBuilder::split_edge(int from_id, int to_id) {
+  int new_node_id =
+      add_corner_inside_edge(from_id, to_id, m_graph, m_attributes, m_cycles);
+  m_handler.add_edge_variables(from_id, new_node_id);
+  m_handler.add_edge_variables(to_id, new_node_id);
+  if (m_last_shape.has_value())
+    split_shape_edge(*m_last_shape, from_id, new_node_id, to_id);
+  m_cnf_builder.clear();
+  add_constraints_one_direction_for_edge(from_id, new_node_id, m_cnf_builder,
+                                         m_handler);
+  add_constraints_one_direction_for_edge(to_id, new_node_id, m_cnf_builder,
+                                         m_handler);
+  m_solver->add_clauses(m_cnf_builder);
+  for (int node_id : {from_id, to_id}) {
+    retire_selector(m_node_to_selector.at(node_id));
+    add_node_clauses(node_id);
+  }
+  add_node_clauses(new_node_id);
+  for (int i = 0; i < m_cycles.size(); i++) {
+    const auto& cycle = m_cycles[i];
+    if (std::find(cycle.begin(), cycle.end(), new_node_id) == cycle.end())
+      continue;
+    retire_selector(m_cycle_to_selector[i]);
+    add_cycle_clauses(i);
+  }
+}
+
+std::vector<std::pair<int, int>> IncrementalShapeBuilder::choose_edges_to_split(
+    const std::vector<int>& failed_selectors) {
+  std::unordered_set<int> failed_nodes;
+  std::vector<int> failed_cycles;
+  for (int selector : failed_selectors) {
+    if (m_selector_to_node.contains(selector))
+      failed_nodes.insert(m_selector_to_node.at(selector));
+    else if (m_selector_to_cycle.contains(selector))
+      failed_cycles.push_back(m_selector_to_cycle.at(selector));
+  }
+  // prefer edges of failed cycles whose endpoints are both in failed nodes,
+  // then any edge of a failed cycle, then any edge of a failed node
+  std::vector<std::pair<int, int>> candidates;
+  std::vector<std::pair<int, int>> cycles_edges;
+  for (int cycle_index : failed_cycles) {
+    const auto& cycle = m_cycles[cycle_index];
+    for (int k = 0; k < cycle.size(); k++) {
+      int i = cycle[k];
+      int j = cycle[(k + 1) % cycle.size()];
+      cycles_edges.push_back({i, j});
+      if (failed_nodes.contains(i) && failed_nodes.contains(j))
+        candidates.push_back({i, j});
+    }
+  }
+  if (candidates.empty()) candidates = std::move(cycles_edges);
+  if (candidates.empty())
+    for (int i : failed_nodes)
+      for (auto& edge : m_graph.get_node_by_id(i).get_edges())
+        candidates.push_back({i, edge.get_to().get_id()});
+  if (candidates.empty())
+    throw std::runtime_error(
+        "IncrementalShapeBuilder::choose_edges_to_split: no failed "
+        "constraints");
+  std::shuffle(candidates.begin(), candidates.end(), m_random_engine);
+  std::vector<std::pair<int, int>> edges;
+  for (auto [i, j] : candidates) {
+    std::pair<int, int> edge = {std::min(i, j), std::max(i, j)};
+    if (std::find(edges.begin(), edges.end(), edge) != edges.end()) continue;
+    edges.push_back(edge);
+    if (static_cast<int>(edges.size()) == m_corners_per_round) break;
+  }
+  return edges;
+}
+
+void IncrementalShapeBuilder::add_cycle(const std::vector<int>& cycle) {
+  m_cycles.push_back(cycle);
+  add_cycle_clauses(m_cycles.size() - 1);
+}
+
+std::vector<int> IncrementalShapeBuilder::get_assumptions() const {
+  std::vector<int> assumptions;
+  for (auto& [node_id, selector] : m_node_to_selector)
+    assumptions.push_back(selector);
+  for (int selector : m_cycle_to_selector) assumptions.push_back(selector);
+  return assumptions;
+}
+
+std::optional<Shape> IncrementalShapeBuilder::build_shape_or_add_corner() {
+  if (m_last_shape.has_value())
+    m_solver->set_phase_hints(
+        shape_to_phase_hints(m_graph, *m_last_shape, m_handler));
+  // the builder lives as long as the drawing, so do its solver's stats
+  const double solve_time = m_solver->get_stats().solve_time;
+  if (m_seconds_per_drawing > 0.0 && solve_time >= m_seconds_per_drawing)
+    throw DrawingBudgetExhausted();
+  m_solver->set_time_budget(get_solve_time_budget(
+      m_seconds_per_solve, m_seconds_per_drawing, solve_time));
+  auto results = m_solver->solve(get_assumptions());
+  if (results.result == GlucoseResultType::UNKNOWN) {
+    for (auto [from_id, to_id] : choose_edges_after_unknown(
+             m_graph, m_cycles, m_random_engine, m_corners_per_round))
+      split_edge(from_id, to_id);
+    return std::nullopt;
+  }
+  if (results.result == GlucoseResultType::UNSAT) {
+    for (auto [from_id, to_id] :
+         choose_edges_to_split(results.failed_assumptions))
+      split_edge(from_id, to_id);
+    return std::nullopt;
+  }
+  m_handler.reset_variables_values();
+  m_last_shape = result_to_shape(m_graph, results.numbers, m_handler);
+  return m_last_shape;
+}
+
+void IncrementalShapeBuilder::set_phases(const Shape& shape) {
+  m_last_shape = shape;
+  carry_shape_over_splits(m_graph, *m_last_shape);
+}
+
+Shape IncrementalShapeBuilder::build_shape() {
+  auto shape = build_shape_or_add_corner();
+  while (!shape.has_value()) shape = build_shape_or_add_corner();
+  return std::move(shape.value());
+}
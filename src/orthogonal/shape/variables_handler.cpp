@@ -1,5 +1,26 @@
 #include "orthogonal/shape/variables_handler.hpp"
 
+#include <cstdlib>
+
+const std::string direction_encoding_to_string(
+    const DirectionEncoding encoding) {
+  switch (encoding) {
+    case DirectionEncoding::ONE_HOT:
+      return "one_hot";
+    case DirectionEncoding::COMPACT:
+      return "compact";
+    default:
+      throw std::invalid_argument("Unknown direction encoding");
+  }
+}
+
+DirectionEncoding string_to_direction_encoding(const std::string& encoding) {
+  if (encoding == "one_hot") return DirectionEncoding::ONE_HOT;
+  if (encoding == "compact") return DirectionEncoding::COMPACT;
+  throw std::invalid_argument("Invalid direction encoding string: " +
+                              encoding);
+}
+
 void VariablesHandler::add_variable(int i, int j, Direction direction) {
   variable_to_edge[m_next_var] = std::make_pair(i, j);
   variable_to_direction[m_next_var] = direction;
@@ -24,14 +45,33 @@ void VariablesHandler::add_variable(int i, int j, Direction direction) {
   m_next_var++;
 }
 
+void VariablesHandler::add_compact_variables(int i, int j) {
+  int horizontal = m_next_var++;
+  int positive = m_next_var++;
+  m_edge_horizontal_variable[{i, j}] = horizontal;
+  m_edge_horizontal_variable[{j, i}] = horizontal;
+  m_edge_positive_literal[{i, j}] = positive;
+  m_edge_positive_literal[{j, i}] = -positive;
+  variable_to_edge[horizontal] = std::make_pair(i, j);
+  variable_to_edge[positive] = std::make_pair(i, j);
+}
+
 void VariablesHandler::add_edge_variables(int i, int j) {
+  if (m_encoding == DirectionEncoding::COMPACT) {
+    add_compact_variables(i, j);
+    return;
+  }
   add_variable(i, j, Direction::UP);
   add_variable(i, j, Direction::DOWN);
   add_variable(i, j, Direction::LEFT);
   add_variable(i, j, Direction::RIGHT);
 }
 
-VariablesHandler::VariablesHandler(const Graph& graph) {
+int VariablesHandler::add_auxiliary_variable() { return m_next_var++; }
+
+VariablesHandler::VariablesHandler(const Graph& graph,
+                                   DirectionEncoding encoding)
+    : m_encoding(encoding) {
   for (const auto& node : graph.get_nodes()) {
     int i = node.get_id();
     for (auto& edge : node.get_edges()) {
@@ -66,12 +106,61 @@ int VariablesHandler::get_variable(int i, int j, Direction direction) const {
   throw std::invalid_argument("Invalid direction");
 }
 
+std::vector<int> VariablesHandler::get_direction_literals(
+    int i, int j, Direction direction) const {
+  if (m_encoding == DirectionEncoding::ONE_HOT)
+    return {get_variable(i, j, direction)};
+  int horizontal = m_edge_horizontal_variable.at({i, j});
+  int positive = m_edge_positive_literal.at({i, j});
+  switch (direction) {
+    case Direction::UP:
+      return {-horizontal, positive};
+    case Direction::DOWN:
+      return {-horizontal, -positive};
+    case Direction::RIGHT:
+      return {horizontal, positive};
+    case Direction::LEFT:
+      return {horizontal, -positive};
+  }
+  throw std::invalid_argument("Invalid direction");
+}
+
+int VariablesHandler::get_direction_literal(int i, int j,
+                                            Direction direction) {
+  if (m_encoding == DirectionEncoding::ONE_HOT)
+    return get_variable(i, j, direction);
+  auto& literals = m_edge_direction_literals[{i, j}];
+  int& literal = literals[static_cast<int>(direction)];
+  if (literal != 0) return literal;
+  // half definition: the literal implies the direction, which is enough
+  // since it only appears positively in "at least one" clauses
+  literal = m_next_var++;
+  m_edge_direction_literals[{j, i}][static_cast<int>(
+      opposite_direction(direction))] = literal;
+  variable_to_edge[literal] = std::make_pair(i, j);
+  for (int lit : get_direction_literals(i, j, direction))
+    m_new_definitions.push_back({{i, j}, {-literal, lit}});
+  return literal;
+}
+
+std::vector<DirectionDefinition> VariablesHandler::take_new_definitions() {
+  return std::exchange(m_new_definitions, {});
+}
+
 const std::pair<int, int>& VariablesHandler::get_edge_of_variable(
     int variable) const {
   return variable_to_edge.at(variable);
 }
 
 Direction VariablesHandler::get_direction_of_edge(int i, int j) const {
+  if (m_encoding == DirectionEncoding::COMPACT) {
+    bool horizontal = get_variable_value(m_edge_horizontal_variable.at({i, j}));
+    int positive_literal = m_edge_positive_literal.at({i, j});
+    bool positive = get_variable_value(std::abs(positive_literal)) ==
+                    (positive_literal > 0);
+    if (horizontal) return positive ? Direction::RIGHT : Direction::LEFT;
+    return positive ? Direction::UP : Direction::DOWN;
+  }
   if (get_variable_value(get_up_variable(i, j))) return Direction::UP;
   if (get_variable_value(get_down_variable(i, j))) return Direction::DOWN;
   if (get_variable_value(get_left_variable(i, j))) return Direction::LEFT;
@@ -89,4 +178,6 @@ bool VariablesHandler::get_variable_value(int variable) const {
   if (!variable_to_value.contains(variable))
     throw std::runtime_error("variable does not have a set value");
   return variable_to_value.at(variable);
-}
\ No newline at end of file
+}
+
+void VariablesHandler::reset_variables_values() { variable_to_value.clear(); }
\ No newline at end of file
@@ -11,19 +11,52 @@ const std::string project_path = std::filesystem::current_path().string() + "/";
 const std::string cnf_logs_file = "cnf_logs.txt";
 std::mutex cnf_logs_mutex;
 
-void CnfBuilder::add_clause(std::vector<int> clause) {
+void CnfBuilder::add_clause(std::span<const int> clause) {
   for (int lit : clause) m_num_vars = std::max(m_num_vars, std::abs(lit));
-  m_rows.push_back({CnfRowType::CLAUSE, std::move(clause), ""});
-  m_num_clauses++;
+  m_literals.insert(m_literals.end(), clause.begin(), clause.end());
+  m_clause_offsets.push_back(m_literals.size());
 }
 
 void CnfBuilder::add_comment(const std::string& comment) {
-  m_rows.push_back({CnfRowType::COMMENT, {}, comment});
+  if (m_keep_comments) m_comments.push_back({get_number_of_clauses(), comment});
 }
 
 int CnfBuilder::get_number_of_variables() const { return m_num_vars; }
 
-int CnfBuilder::get_number_of_clauses() const { return m_num_clauses; }
+int CnfBuilder::get_number_of_clauses() const {
+  return m_clause_offsets.size() - 1;
+}
+
+std::span<const int> CnfBuilder::get_clause(int index) const {
+  return std::span<const int>(m_literals.data() + m_clause_offsets[index],
+                              m_literals.data() + m_clause_offsets[index + 1]);
+}
+
+void CnfBuilder::for_each_clause(
+    const std::function<void(std::span<const int>)>& function) const {
+  for (int i = 0; i < get_number_of_clauses(); i++) function(get_clause(i));
+}
+
+void CnfBuilder::clear() {
+  m_num_vars = 0;
+  m_literals.clear();
+  m_clause_offsets.resize(1);
+  m_comments.clear();
+}
+
+void CnfBuilder::write_dimacs(std::ostream& stream) const {
+  stream << "p cnf " << get_number_of_variables() << " "
+         << get_number_of_clauses() << "\n";
+  auto comment = m_comments.begin();
+  for (int i = 0; i < get_number_of_clauses(); i++) {
+    for (; comment != m_comments.end() && comment->first == i; comment++)
+      stream << "c " << comment->second << "\n";
+    for (int lit : get_clause(i)) stream << lit << " ";
+    stream << "0\n";
+  }
+  for (; comment != m_comments.end(); comment++)
+    stream << "c " << comment->second << "\n";
+}
 
 void CnfBuilder::convert_to_cnf(const std::string& file_path) const {
   std::ofstream file(file_path);
@@ -32,19 +65,7 @@ void CnfBuilder::convert_to_cnf(const std::string& file_path) const {
               << " for writing.\n";
     return;
   }
-  file << "p cnf " << get_number_of_variables() << " "
-       << get_number_of_clauses() << "\n";
-  for (const auto& row : m_rows) {
-    switch (row.m_type) {
-      case CnfRowType::COMMENT:
-        file << "c " << row.m_comment << "\n";
-        break;
-      case CnfRowType::CLAUSE:
-        for (int lit : row.m_clause) file << lit << " ";
-        file << "0\n";
-        break;
-    }
-  }
+  write_dimacs(file);
   file.close();
   std::lock_guard<std::mutex> lock(cnf_logs_mutex);
   std::ofstream log_file(cnf_logs_file, std::ios_base::app);
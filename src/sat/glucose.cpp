@@ -1,81 +1,171 @@
 #include "sat/glucose.hpp"
 
-#include <fstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <iostream>
-#include <random>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
 
-#include "core/utils.hpp"
+#include "sat/solver_process.hpp"
 
 std::string GlucoseResult::to_string() const {
-  std::string r = result == GlucoseResultType::SAT ? "SAT" : "UNSAT";
+  std::string r = result == GlucoseResultType::SAT     ? "SAT"
+                  : result == GlucoseResultType::UNSAT ? "UNSAT"
+                                                       : "UNKNOWN";
   std::string numbers_str = "Numbers: ";
   for (int num : numbers) numbers_str += std::to_string(num) + " ";
+  std::string failed_str = "Failed assumptions: ";
+  for (int lit : failed_assumptions) failed_str += std::to_string(lit) + " ";
   std::string proof_str = "Proof:\n";
   for (const std::string& line : proof_lines) proof_str += line + "\n";
-  return r + "\n" + numbers_str + "\n" + proof_str;
+  return r + "\n" + numbers_str + "\n" + failed_str + "\n" + proof_str;
 }
 
 void GlucoseResult::print() const { std::cout << to_string() << std::endl; }
 
-GlucoseResult get_results(const std::string& output_file,
-                          const std::string& proof_file);
-
-void delete_glucose_temp_files(const std::string& output_file,
-                               const std::string& proof_file) {
-  remove(output_file.c_str());
-  remove(proof_file.c_str());
+std::vector<std::string> build_glucose_arguments(unsigned random_seed,
+                                                 bool with_proof) {
+  // -verb=1 for the statistics, where the conflicts are read from
+  std::vector<std::string> arguments = {"./glucose", "-verb=1", "-model"};
+  if (with_proof) {
+    arguments.push_back("-certified");
+    arguments.push_back("-certified-output=/dev/fd/3");
+  }
+  if (random_seed != 0) {
+    arguments.push_back("-rnd-init");
+    arguments.push_back("-rnd-seed=" + std::to_string(random_seed));
+    arguments.push_back("-rnd-freq=0.2");
+    arguments.push_back("-phase-restart=2");
+  }
+  return arguments;
 }
 
-GlucoseResult launch_glucose(const std::string& conjunctive_normal_form_file,
-                             bool randomize) {
-  const std::string proof_file = get_unique_filename("proof");
-  const std::string output_file = get_unique_filename("output");
-  std::string command;
-  const std::string proof_path = "-certified-output=" + proof_file;
-  if (randomize) {
-    const std::string rnd_seed =
-        "-rnd-seed=" + std::to_string(std::random_device{}());
-    const std::string rnd_freq = "-rnd-freq=0.2";
-    const std::string phase_restart = "-phase-restart=2";
-    command = "./glucose" + conjunctive_normal_form_file + " " + output_file +
-              " " + proof_path + " -certified " + "-rnd-init " + rnd_seed +
-              " " + rnd_freq + " " + phase_restart;
-  } else {
-    command = "./glucose " + conjunctive_normal_form_file + " " + output_file +
-              " -certified " + proof_path;
+// writes the input and drains the output and the proof at the same time, so
+// that the child never blocks on a full pipe; returns false if interrupted
+bool exchange_with_glucose(const std::string& input, int input_fd,
+                           int output_fd, int proof_fd, std::string& output,
+                           std::string& proof,
+                           const std::atomic<bool>* interrupted) {
+  fcntl(input_fd, F_SETFL, fcntl(input_fd, F_GETFL) | O_NONBLOCK);
+  size_t written = 0;
+  char buffer[1 << 16];
+  // without an interrupt flag there is nothing to check between events
+  const int timeout_ms = (interrupted != nullptr) ? 10 : -1;
+  while (input_fd != -1 || output_fd != -1 || proof_fd != -1) {
+    if (interrupted != nullptr && interrupted->load()) {
+      for (int* fd : {&input_fd, &output_fd, &proof_fd}) close_if_open(*fd);
+      return false;
+    }
+    pollfd fds[3] = {{input_fd, POLLOUT, 0},
+                     {output_fd, POLLIN, 0},
+                     {proof_fd, POLLIN, 0}};
+    if (poll(fds, 3, timeout_ms) == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("launch_glucose: poll failed");
+    }
+    if (fds[0].revents & (POLLERR | POLLHUP)) {
+      close_if_open(input_fd);
+    } else if (fds[0].revents & POLLOUT) {
+      ssize_t n = write(input_fd, input.data() + written,
+                        std::min(input.size() - written, sizeof(buffer)));
+      if (n > 0) written += n;
+      if (n == -1 && errno != EAGAIN && errno != EINTR)
+        close_if_open(input_fd);
+      if (written == input.size()) close_if_open(input_fd);
+    }
+    for (auto [index, fd, target] : {std::tuple(1, &output_fd, &output),
+                                     std::tuple(2, &proof_fd, &proof)}) {
+      if (!(fds[index].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      ssize_t n = read(*fd, buffer, sizeof(buffer));
+      if (n > 0)
+        target->append(buffer, n);
+      else if (n == 0 || (errno != EAGAIN && errno != EINTR))
+        close_if_open(*fd);
+    }
   }
-  command += " > /dev/null 2>&1";
-  std::system(command.c_str());
-  GlucoseResult result = get_results(output_file, proof_file);
-  delete_glucose_temp_files(output_file, proof_file);
-  return std::move(result);
+  return true;
 }
 
-std::vector<std::string> get_proof(const std::string& proof_file) {
-  std::ifstream file(proof_file.c_str());
-  if (!file) throw std::runtime_error("Error: Could not open the file.");
-  std::vector<std::string> proof_lines;
+std::vector<std::string> split_lines(const std::string& text) {
+  std::vector<std::string> lines;
+  std::istringstream stream(text);
   std::string line;
-  while (std::getline(file, line)) proof_lines.push_back(line);
-  return proof_lines;
+  while (std::getline(stream, line)) lines.push_back(line);
+  return lines;
 }
 
-GlucoseResult get_results(const std::string& output_file,
-                          const std::string& proof_file) {
-  std::ifstream file(output_file.c_str());
-  if (!file) throw std::runtime_error("Error: Could not open the file.");
-  std::string line;
-  if (std::getline(file, line)) {
-    if (line == "UNSAT")
-      return GlucoseResult{GlucoseResultType::UNSAT, {}, get_proof(proof_file)};
-    std::istringstream iss(line);
-    std::vector<int> numbers;
+GlucoseResult parse_glucose_output(const std::string& output,
+                                   std::vector<std::string>&& proof_lines) {
+  std::optional<GlucoseResultType> result;
+  std::vector<int> numbers;
+  long long conflicts = 0;
+  for (const auto& line : split_lines(output)) {
+    if (line == "s SATISFIABLE") result = GlucoseResultType::SAT;
+    if (line == "s UNSATISFIABLE") result = GlucoseResultType::UNSAT;
+    // c conflicts             : 1234           (5678 /sec)
+    if (line.starts_with("c conflicts")) {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos)
+        std::istringstream(line.substr(colon + 1)) >> conflicts;
+    }
+    if (line.rfind("v ", 0) != 0) continue;
+    std::istringstream iss(line.substr(2));
     int num;
-    while (iss >> num) numbers.push_back(num);
-    return GlucoseResult{GlucoseResultType::SAT, numbers,
-                         get_proof(proof_file)};
+    while (iss >> num)
+      if (num != 0) numbers.push_back(num);
   }
-  throw std::runtime_error("Error: the file is empty.");
-}
\ No newline at end of file
+  if (!result.has_value())
+    throw std::runtime_error("launch_glucose: no result in glucose output");
+  if (result == GlucoseResultType::UNSAT) numbers.clear();
+  return GlucoseResult{*result, std::move(numbers), std::move(proof_lines), {},
+                       conflicts};
+}
+
+GlucoseResult launch_glucose(const CnfBuilder& cnf_builder,
+                             unsigned random_seed, bool with_proof,
+                             const std::atomic<bool>* interrupted) {
+  std::ostringstream dimacs;
+  cnf_builder.write_dimacs(dimacs);
+  int input_pipe[2], output_pipe[2], proof_pipe[2] = {-1, -1};
+  make_pipe(input_pipe);
+  make_pipe(output_pipe);
+  if (with_proof) make_pipe(proof_pipe);
+  pid_t pid;
+  try {
+    pid = spawn_solver_process(build_glucose_arguments(random_seed, with_proof),
+                               input_pipe[0], output_pipe[1], proof_pipe[1]);
+  } catch (...) {
+    for (int fd : {input_pipe[0], input_pipe[1], output_pipe[0],
+                   output_pipe[1], proof_pipe[0], proof_pipe[1]})
+      if (fd != -1) close(fd);
+    throw;
+  }
+  close_if_open(input_pipe[0]);
+  close_if_open(output_pipe[1]);
+  close_if_open(proof_pipe[1]);
+  std::string output, proof;
+  bool finished;
+  {
+    SigpipeBlocker sigpipe_blocker;
+    finished =
+        exchange_with_glucose(dimacs.str(), input_pipe[1], output_pipe[0],
+                              proof_pipe[0], output, proof, interrupted);
+  }
+  if (!finished) {
+    kill(pid, SIGKILL);
+    while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+    }
+    return GlucoseResult{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+  }
+  // glucose exits with 10 when SAT and 20 when UNSAT
+  wait_solver_process(pid, {10, 20});
+  return parse_glucose_output(output, split_lines(proof));
+}
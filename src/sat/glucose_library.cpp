@@ -0,0 +1,161 @@
+#include <stdio.h>
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#include "core/Solver.h"
+#include "sat/sat_solver.hpp"
+
+Glucose::Lit to_glucose_literal(int lit) {
+  return Glucose::mkLit(std::abs(lit) - 1, lit < 0);
+}
+
+int from_glucose_literal(Glucose::Lit lit) {
+  return Glucose::sign(lit) ? -(Glucose::var(lit) + 1)
+                            : Glucose::var(lit) + 1;
+}
+
+class GlucoseLibrarySolverImpl {
+ private:
+  Glucose::Solver m_solver;
+  // the proof is written to memory instead of a file in /dev/shm
+  FILE* m_proof_stream = nullptr;
+  char* m_proof_buffer = nullptr;
+  size_t m_proof_size = 0;
+  Glucose::vec<Glucose::Lit> m_literals;
+  long long m_conflict_budget = 0;
+
+  void reserve_variable(int lit) {
+    while (m_solver.nVars() < std::abs(lit)) m_solver.newVar();
+  }
+
+  std::vector<std::string> get_proof_lines() {
+    std::vector<std::string> proof_lines;
+    if (m_proof_stream == nullptr) return proof_lines;
+    fflush(m_proof_stream);
+    std::istringstream stream(std::string(m_proof_buffer, m_proof_size));
+    std::string line;
+    while (std::getline(stream, line)) proof_lines.push_back(line);
+    return proof_lines;
+  }
+
+ public:
+  GlucoseLibrarySolverImpl(bool with_proof) {
+    if (!with_proof) return;
+    m_proof_stream = open_memstream(&m_proof_buffer, &m_proof_size);
+    if (m_proof_stream == nullptr)
+      throw std::runtime_error(
+          "GlucoseLibrarySolver: could not open proof stream");
+    m_solver.certifiedUNSAT = true;
+    m_solver.certifiedOutput = m_proof_stream;
+  }
+
+  void add_clause(std::span<const int> clause) {
+    m_literals.clear();
+    for (int lit : clause) {
+      reserve_variable(lit);
+      m_literals.push(to_glucose_literal(lit));
+    }
+    m_solver.addClause(m_literals);
+  }
+
+  GlucoseResult solve(const std::vector<int>& assumptions) {
+    m_literals.clear();
+    for (int lit : assumptions) {
+      reserve_variable(lit);
+      m_literals.push(to_glucose_literal(lit));
+    }
+    // glucose budgets are counted from the conflicts done so far
+    if (m_conflict_budget > 0)
+      m_solver.setConfBudget(m_conflict_budget);
+    else
+      m_solver.budgetOff();
+    const uint64_t conflicts_before = m_solver.conflicts;
+    // solve() would report an interrupted search as UNSAT
+    const Glucose::lbool status =
+        m_solver.okay() ? m_solver.solveLimited(m_literals) : l_False;
+    const long long conflicts = m_solver.conflicts - conflicts_before;
+    if (status == l_Undef) {
+      GlucoseResult result{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+      result.conflicts = conflicts;
+      return result;
+    }
+    if (status == l_False) {
+      GlucoseResult result{GlucoseResultType::UNSAT, {}, get_proof_lines(), {},
+                           0};
+      result.conflicts = conflicts;
+      // glucose stores the negation of the failed assumptions
+      for (int i = 0; i < m_solver.conflict.size(); i++)
+        result.failed_assumptions.push_back(
+            -from_glucose_literal(m_solver.conflict[i]));
+      return result;
+    }
+    std::vector<int> numbers;
+    for (int i = 0; i < m_solver.nVars(); i++)
+      numbers.push_back(m_solver.model[i] == l_True ? i + 1 : -(i + 1));
+    GlucoseResult result{GlucoseResultType::SAT, std::move(numbers), {}, {},
+                         0};
+    result.conflicts = conflicts;
+    return result;
+  }
+
+  void set_phase_hints(const std::vector<int>& literals) {
+    for (int lit : literals) {
+      reserve_variable(lit);
+      // glucose polarity true means the variable is tried as false first
+      m_solver.setPolarity(std::abs(lit) - 1, lit < 0);
+    }
+  }
+
+  void set_random_seed(unsigned seed) {
+    // glucose needs a positive seed
+    m_solver.random_seed = seed + 1.0;
+    m_solver.random_var_freq = 0.02;
+  }
+
+  void set_conflict_budget(long long conflicts) {
+    m_conflict_budget = conflicts;
+  }
+
+  void interrupt() { m_solver.interrupt(); }
+
+  void clear_interrupt() { m_solver.clearInterrupt(); }
+
+  ~GlucoseLibrarySolverImpl() {
+    if (m_proof_stream == nullptr) return;
+    fclose(m_proof_stream);
+    free(m_proof_buffer);
+  }
+};
+
+GlucoseLibrarySolver::GlucoseLibrarySolver(bool with_proof)
+    : m_impl(std::make_unique<GlucoseLibrarySolverImpl>(with_proof)) {}
+
+void GlucoseLibrarySolver::add_clause_to_solver(
+    std::span<const int> clause) {
+  m_impl->add_clause(clause);
+}
+
+GlucoseResult GlucoseLibrarySolver::solve_with_assumptions(
+    const std::vector<int>& assumptions) {
+  return m_impl->solve(assumptions);
+}
+
+void GlucoseLibrarySolver::set_phase_hints(const std::vector<int>& literals) {
+  m_impl->set_phase_hints(literals);
+}
+
+void GlucoseLibrarySolver::set_random_seed(unsigned seed) {
+  m_impl->set_random_seed(seed);
+}
+
+void GlucoseLibrarySolver::set_conflict_budget(long long conflicts) {
+  m_impl->set_conflict_budget(conflicts);
+}
+
+void GlucoseLibrarySolver::interrupt() { m_impl->interrupt(); }
+
+void GlucoseLibrarySolver::clear_interrupt() { m_impl->clear_interrupt(); }
+
+GlucoseLibrarySolver::~GlucoseLibrarySolver() = default;
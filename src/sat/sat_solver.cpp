@@ -0,0 +1,296 @@
+#include "sat/sat_solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include "core/utils.hpp"
+#include "sat/sat_worker_pool.hpp"
+
+const std::string sat_backend_to_string(const SatBackend backend) {
+  switch (backend) {
+    case SatBackend::GLUCOSE_PROCESS:
+      return "glucose_process";
+    case SatBackend::GLUCOSE_LIBRARY:
+      return "glucose_library";
+    case SatBackend::GLUCOSE_POOL:
+      return "glucose_pool";
+    default:
+      throw std::invalid_argument("Unknown sat backend");
+  }
+}
+
+SatBackend string_to_sat_backend(const std::string& backend) {
+  if (backend == "glucose_process") return SatBackend::GLUCOSE_PROCESS;
+  if (backend == "glucose_library") return SatBackend::GLUCOSE_LIBRARY;
+  if (backend == "glucose_pool") return SatBackend::GLUCOSE_POOL;
+  throw std::invalid_argument("Invalid sat backend string: " + backend);
+}
+
+bool reports_failed_assumptions(const SatBackend backend) {
+  return backend == SatBackend::GLUCOSE_LIBRARY ||
+         backend == SatBackend::GLUCOSE_POOL;
+}
+
+void SatStats::add(const SatStats& other) {
+  number_of_solves += other.number_of_solves;
+  number_of_variables += other.number_of_variables;
+  number_of_clauses += other.number_of_clauses;
+  number_of_conflicts += other.number_of_conflicts;
+  number_of_unknown_results += other.number_of_unknown_results;
+  number_of_unproven_optima += other.number_of_unproven_optima;
+  solve_time += other.solve_time;
+}
+
+void SatSolver::add_clause(std::span<const int> clause) {
+  for (int lit : clause)
+    m_stats.number_of_variables =
+        std::max(m_stats.number_of_variables, (long long)std::abs(lit));
+  m_stats.number_of_clauses++;
+  add_clause_to_solver(clause);
+}
+
+GlucoseResult SatSolver::solve(const std::vector<int>& assumptions) {
+  for (int lit : assumptions)
+    m_stats.number_of_variables =
+        std::max(m_stats.number_of_variables, (long long)std::abs(lit));
+  auto start = std::chrono::high_resolution_clock::now();
+  m_deadline.reset();
+  if (m_time_budget > 0.0)
+    m_deadline = std::chrono::steady_clock::now() +
+                 std::chrono::duration_cast<
+                     std::chrono::steady_clock::duration>(
+                     std::chrono::duration<double>(m_time_budget));
+  std::mutex mutex;
+  std::condition_variable solved_condition;
+  bool solved = false;
+  bool timed_out = false;
+  std::thread watchdog;
+  if (m_time_budget > 0.0)
+    watchdog = std::thread([&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (solved_condition.wait_for(
+              lock, std::chrono::duration<double>(m_time_budget),
+              [&]() { return solved; }))
+        return;
+      timed_out = true;
+      interrupt();
+    });
+  auto result = solve_with_assumptions(assumptions);
+  if (watchdog.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      solved = true;
+    }
+    solved_condition.notify_one();
+    watchdog.join();
+    if (timed_out) clear_interrupt();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  m_stats.solve_time += std::chrono::duration<double>(end - start).count();
+  m_stats.number_of_solves++;
+  m_stats.number_of_conflicts += result.conflicts;
+  if (result.result == GlucoseResultType::UNKNOWN)
+    m_stats.number_of_unknown_results++;
+  return result;
+}
+
+void SatSolver::add_clauses(const CnfBuilder& cnf_builder) {
+  cnf_builder.for_each_clause(
+      [this](std::span<const int> clause) { add_clause(clause); });
+}
+
+void GlucoseProcessSolver::add_clause_to_solver(
+    std::span<const int> clause) {
+  m_cnf_builder.add_clause(clause);
+}
+
+GlucoseResult GlucoseProcessSolver::solve_with_assumptions(
+    const std::vector<int>& assumptions) {
+  CnfBuilder cnf_builder = m_cnf_builder;
+  for (int assumption : assumptions) cnf_builder.add_clause({assumption});
+  auto results =
+      launch_glucose(cnf_builder, m_random_seed, m_with_proof, &m_interrupted);
+  if (results.result == GlucoseResultType::UNSAT)
+    results.failed_assumptions = assumptions;
+  return results;
+}
+
+// 0 is left for the workers that hold no formula
+static std::atomic<unsigned long long> next_pool_solver_id = 1;
+
+GlucosePoolSolver::GlucosePoolSolver(bool with_proof)
+    : m_id(next_pool_solver_id++), m_with_proof(with_proof) {}
+
+void GlucosePoolSolver::add_clause_to_solver(
+    std::span<const int> clause) {
+  m_cnf_builder.add_clause(clause);
+}
+
+GlucoseResult GlucosePoolSolver::solve_with_assumptions(
+    const std::vector<int>& assumptions) {
+  if (m_interrupted ||
+      (get_deadline().has_value() &&
+       std::chrono::steady_clock::now() >= *get_deadline()))
+    return GlucoseResult{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+  auto worker = get_sat_worker_pool().borrow(m_id, &m_interrupted,
+                                             get_deadline());
+  {
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    if (worker.get() == nullptr || m_interrupted)
+      return GlucoseResult{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+    m_worker = worker.get();
+  }
+  try {
+    auto result =
+        worker->solve(m_id, m_cnf_builder, assumptions, m_with_proof,
+                      m_random_seed, m_conflict_budget, m_phase_hints);
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    m_worker = nullptr;
+    return result;
+  } catch (const std::exception&) {
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    m_worker = nullptr;
+    // the worker was killed by interrupt
+    if (m_interrupted)
+      return GlucoseResult{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+    throw;
+  }
+}
+
+void GlucosePoolSolver::interrupt() {
+  std::lock_guard<std::mutex> lock(m_worker_mutex);
+  m_interrupted = true;
+  if (m_worker != nullptr) m_worker->kill();
+  // a solve waiting for a worker gives up
+  else get_sat_worker_pool().wake_waiting();
+}
+
+void GlucosePoolSolver::clear_interrupt() {
+  std::lock_guard<std::mutex> lock(m_worker_mutex);
+  m_interrupted = false;
+}
+
+PortfolioSolver::PortfolioSolver(
+    std::vector<std::unique_ptr<SatSolver>> solvers)
+    : m_solvers(std::move(solvers)) {
+  if (m_solvers.empty())
+    throw std::invalid_argument("PortfolioSolver: no solvers");
+  for (int i = 0; i < static_cast<int>(m_solvers.size()); i++)
+    m_threads.emplace_back([this, i]() { run_solver(i); });
+}
+
+PortfolioSolver::~PortfolioSolver() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_solve_started.notify_all();
+  for (auto& thread : m_threads) thread.join();
+}
+
+void PortfolioSolver::run_solver(int index) {
+  long long last_solve_index = 0;
+  while (true) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_solve_started.wait(lock, [&]() {
+      return m_stopping || m_solve_index != last_solve_index;
+    });
+    if (m_stopping) return;
+    last_solve_index = m_solve_index;
+    lock.unlock();
+    std::optional<GlucoseResult> result;
+    std::exception_ptr error;
+    try {
+      result = m_solvers[index]->solve(*m_assumptions);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock.lock();
+    if (error != nullptr && m_error == nullptr) m_error = error;
+    if (result.has_value() && !m_winner.has_value() &&
+        result->result != GlucoseResultType::UNKNOWN) {
+      m_winner = std::move(result);
+      for (int j = 0; j < static_cast<int>(m_solvers.size()); j++)
+        if (j != index) m_solvers[j]->interrupt();
+    }
+    if (--m_running_solvers == 0) m_solve_finished.notify_one();
+  }
+}
+
+void PortfolioSolver::add_clause_to_solver(std::span<const int> clause) {
+  for (auto& solver : m_solvers) solver->add_clause(clause);
+}
+
+GlucoseResult PortfolioSolver::solve_with_assumptions(
+    const std::vector<int>& assumptions) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_assumptions = &assumptions;
+  m_winner.reset();
+  m_error = nullptr;
+  m_running_solvers = static_cast<int>(m_solvers.size());
+  m_solve_index++;
+  m_solve_started.notify_all();
+  m_solve_finished.wait(lock, [this]() { return m_running_solvers == 0; });
+  // all the solves are done, no interrupt can arrive after this
+  for (auto& solver : m_solvers) solver->clear_interrupt();
+  if (m_winner.has_value()) return std::move(m_winner.value());
+  if (m_error != nullptr) std::rethrow_exception(m_error);
+  return GlucoseResult{GlucoseResultType::UNKNOWN, {}, {}, {}, 0};
+}
+
+void PortfolioSolver::set_phase_hints(const std::vector<int>& literals) {
+  for (auto& solver : m_solvers) solver->set_phase_hints(literals);
+}
+
+void PortfolioSolver::set_conflict_budget(long long conflicts) {
+  for (auto& solver : m_solvers) solver->set_conflict_budget(conflicts);
+}
+
+void PortfolioSolver::interrupt() {
+  for (auto& solver : m_solvers) solver->interrupt();
+}
+
+void PortfolioSolver::clear_interrupt() {
+  for (auto& solver : m_solvers) solver->clear_interrupt();
+}
+
+std::unique_ptr<SatSolver> make_sat_solver(const SatBackend backend,
+                                           bool with_proof,
+                                           int portfolio_size) {
+  if (portfolio_size > 1) {
+    std::vector<std::unique_ptr<SatSolver>> solvers;
+    for (int i = 0; i < portfolio_size; i++) {
+      solvers.push_back(make_sat_solver(backend, with_proof));
+      if (i > 0) solvers.back()->set_random_seed(i);
+    }
+    return std::make_unique<PortfolioSolver>(std::move(solvers));
+  }
+  switch (backend) {
+    case SatBackend::GLUCOSE_PROCESS:
+      return std::make_unique<GlucoseProcessSolver>(with_proof);
+    case SatBackend::GLUCOSE_POOL:
+      // ./sat_worker links the glucose library, it is built only with it
+#ifdef USE_GLUCOSE_LIBRARY
+      return std::make_unique<GlucosePoolSolver>(with_proof);
+#else
+      throw std::runtime_error(
+          "make_sat_solver: glucose pool backend was not compiled in");
+#endif
+    case SatBackend::GLUCOSE_LIBRARY:
+#ifdef USE_GLUCOSE_LIBRARY
+      return std::make_unique<GlucoseLibrarySolver>(with_proof);
+#else
+      throw std::runtime_error(
+          "make_sat_solver: glucose library backend was not compiled in");
+#endif
+    default:
+      throw std::invalid_argument("Unknown sat backend");
+  }
+}
@@ -0,0 +1,198 @@
+#include "sat/sat_worker_pool.hpp"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "sat/solver_process.hpp"
+
+SatWorker::SatWorker() {
+  int to_worker[2], from_worker[2];
+  make_pipe(to_worker);
+  make_pipe(from_worker);
+  try {
+    m_pid = spawn_solver_process({"./sat_worker"}, to_worker[0],
+                                 from_worker[1]);
+  } catch (...) {
+    for (int fd : {to_worker[0], to_worker[1], from_worker[0], from_worker[1]})
+      close(fd);
+    throw;
+  }
+  close(to_worker[0]);
+  close(from_worker[1]);
+  m_to_worker = fdopen(to_worker[1], "w");
+  m_from_worker = fdopen(from_worker[0], "r");
+}
+
+std::vector<int> parse_literals(const std::string& line) {
+  std::vector<int> literals;
+  std::istringstream iss(line.substr(2));
+  int lit;
+  while (iss >> lit)
+    if (lit != 0) literals.push_back(lit);
+  return literals;
+}
+
+GlucoseResult SatWorker::solve(unsigned long long owner,
+                               const CnfBuilder& cnf_builder,
+                               const std::vector<int>& assumptions,
+                               bool with_proof, unsigned random_seed,
+                               long long conflict_budget,
+                               const std::vector<int>& phase_hints) {
+  const bool keeps_solver =
+      owner != 0 && owner == m_owner &&
+      m_sent_clauses <= cnf_builder.get_number_of_clauses();
+  // a worker that fails in the middle of a job is left in an unknown state
+  m_broken = true;
+  m_owner = 0;
+  {
+    SigpipeBlocker sigpipe_blocker;
+    if (keeps_solver) {
+      fprintf(m_to_worker, "u %lld\n", conflict_budget);
+    } else {
+      fprintf(m_to_worker, "j %d %u %lld\n", with_proof ? 1 : 0, random_seed,
+              conflict_budget);
+      m_sent_clauses = 0;
+    }
+    if (!phase_hints.empty()) {
+      fputs("p", m_to_worker);
+      for (int lit : phase_hints) fprintf(m_to_worker, " %d", lit);
+      fputs(" 0\n", m_to_worker);
+    }
+    const int number_of_clauses = cnf_builder.get_number_of_clauses();
+    for (int i = m_sent_clauses; i < number_of_clauses; i++) {
+      for (int lit : cnf_builder.get_clause(i))
+        fprintf(m_to_worker, "%d ", lit);
+      fputs("0\n", m_to_worker);
+    }
+    m_sent_clauses = number_of_clauses;
+    fputs("a", m_to_worker);
+    for (int lit : assumptions) fprintf(m_to_worker, " %d", lit);
+    fputs(" 0\n", m_to_worker);
+    if (fflush(m_to_worker) != 0)
+      throw std::runtime_error("SatWorker::solve: could not send the job");
+  }
+  GlucoseResult result{GlucoseResultType::UNSAT, {}, {}, {}, 0};
+  bool has_answer = false;
+  char* buffer = nullptr;
+  size_t capacity = 0;
+  ssize_t length;
+  while ((length = getline(&buffer, &capacity, m_from_worker)) != -1) {
+    std::string line(buffer, length);
+    if (!line.empty() && line.back() == '\n') line.pop_back();
+    if (line == "e") {
+      free(buffer);
+      if (!has_answer)
+        throw std::runtime_error("SatWorker::solve: answer without result");
+      m_broken = false;
+      m_owner = owner;
+      return result;
+    }
+    if (line == "s SATISFIABLE") {
+      result.result = GlucoseResultType::SAT;
+      has_answer = true;
+    } else if (line == "s UNSATISFIABLE") {
+      has_answer = true;
+    } else if (line == "s UNKNOWN") {
+      result.result = GlucoseResultType::UNKNOWN;
+      has_answer = true;
+    } else if (line.starts_with("v ")) {
+      result.numbers = parse_literals(line);
+    } else if (line.starts_with("f ")) {
+      result.failed_assumptions = parse_literals(line);
+    } else if (line.starts_with("r ")) {
+      result.proof_lines.push_back(line.substr(2));
+    } else if (line.starts_with("c ")) {
+      result.conflicts = std::stoll(line.substr(2));
+    }
+  }
+  free(buffer);
+  throw std::runtime_error("SatWorker::solve: worker closed the connection");
+}
+
+void SatWorker::kill() {
+  m_killed = true;
+  ::kill(m_pid, SIGKILL);
+}
+
+SatWorker::~SatWorker() {
+  // the worker exits when its stdin is closed
+  fclose(m_to_worker);
+  fclose(m_from_worker);
+  try {
+    wait_solver_process(m_pid, {0});
+  } catch (const std::exception&) {
+  }
+}
+
+SatWorkerLease::~SatWorkerLease() {
+  if (m_worker != nullptr) m_pool.release(m_worker);
+}
+
+SatWorkerLease SatWorkerPool::borrow(
+    unsigned long long owner, const std::atomic<bool>* cancelled,
+    std::optional<std::chrono::steady_clock::time_point> deadline) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto is_cancelled = [cancelled]() {
+    return cancelled != nullptr && cancelled->load();
+  };
+  auto can_borrow = [&]() {
+    return is_cancelled() || !m_idle_workers.empty() ||
+           static_cast<int>(m_workers.size()) < m_max_workers;
+  };
+  if (deadline.has_value()) {
+    if (!m_worker_released.wait_until(lock, *deadline, can_borrow))
+      return SatWorkerLease(*this, nullptr);
+  } else {
+    m_worker_released.wait(lock, can_borrow);
+  }
+  if (is_cancelled()) return SatWorkerLease(*this, nullptr);
+  if (!m_idle_workers.empty()) {
+    auto it = std::find_if(
+        m_idle_workers.begin(), m_idle_workers.end(),
+        [owner](SatWorker* worker) { return worker->get_owner() == owner; });
+    if (owner == 0 || it == m_idle_workers.end())
+      it = std::prev(m_idle_workers.end());
+    SatWorker* worker = *it;
+    m_idle_workers.erase(it);
+    return SatWorkerLease(*this, worker);
+  }
+  m_workers.push_back(std::make_unique<SatWorker>());
+  return SatWorkerLease(*this, m_workers.back().get());
+}
+
+void SatWorkerPool::release(SatWorker* worker) {
+  // destroyed after the lock is released, it waits for the process to exit
+  std::unique_ptr<SatWorker> broken_worker;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (worker->is_broken()) {
+      auto it = std::find_if(
+          m_workers.begin(), m_workers.end(),
+          [worker](const auto& owned) { return owned.get() == worker; });
+      broken_worker = std::move(*it);
+      m_workers.erase(it);
+    } else {
+      m_idle_workers.push_back(worker);
+    }
+  }
+  // a borrow that gave up may be the one woken, all of them check again
+  m_worker_released.notify_all();
+}
+
+void SatWorkerPool::wake_waiting() {
+  // taken so that a borrow cannot miss the flag between its check and its wait
+  { std::lock_guard<std::mutex> lock(m_mutex); }
+  m_worker_released.notify_all();
+}
+
+SatWorkerPool& get_sat_worker_pool() {
+  static SatWorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+  return pool;
+}
@@ -0,0 +1,81 @@
+#include "sat/solver_process.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+extern char** environ;
+
+void make_pipe(int fds[2]) {
+  if (pipe2(fds, O_CLOEXEC) == -1)
+    throw std::runtime_error("make_pipe: could not create pipe");
+}
+
+void close_if_open(int& fd) {
+  if (fd == -1) return;
+  close(fd);
+  fd = -1;
+}
+
+pid_t spawn_solver_process(const std::vector<std::string>& arguments,
+                           int input_fd, int output_fd, int extra_fd) {
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  // dup2 clears close-on-exec on the descriptors the child keeps
+  posix_spawn_file_actions_adddup2(&actions, input_fd, STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, output_fd, STDOUT_FILENO);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+  if (extra_fd != -1) posix_spawn_file_actions_adddup2(&actions, extra_fd, 3);
+  std::vector<char*> argv;
+  for (const auto& argument : arguments)
+    argv.push_back(const_cast<char*>(argument.c_str()));
+  argv.push_back(nullptr);
+  pid_t pid;
+  int error =
+      posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (error != 0)
+    throw std::runtime_error("spawn_solver_process: could not spawn " +
+                             arguments[0] + ": " + std::strerror(error));
+  return pid;
+}
+
+int wait_solver_process(pid_t pid, const std::vector<int>& exit_codes) {
+  int status;
+  while (waitpid(pid, &status, 0) == -1)
+    if (errno != EINTR)
+      throw std::runtime_error("wait_solver_process: waitpid failed");
+  if (!WIFEXITED(status) ||
+      std::find(exit_codes.begin(), exit_codes.end(), WEXITSTATUS(status)) ==
+          exit_codes.end())
+    throw std::runtime_error("wait_solver_process: solver process failed");
+  return WEXITSTATUS(status);
+}
+
+SigpipeBlocker::SigpipeBlocker() {
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, &m_old_mask);
+}
+
+SigpipeBlocker::~SigpipeBlocker() {
+  // drop the SIGPIPE raised while blocked, otherwise it is delivered as soon
+  // as the old mask is restored
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  const timespec no_wait = {0, 0};
+  while (sigtimedwait(&sigpipe, nullptr, &no_wait) > 0) {
+  }
+  pthread_sigmask(SIG_SETMASK, &m_old_mask, nullptr);
+}
@@ -0,0 +1,38 @@
+#include "sat/totalizer.hpp"
+
+#include <algorithm>
+
+std::vector<int> build_totalizer(SatSolver& solver,
+                                 const std::vector<int>& inputs, int begin,
+                                 int end, int limit,
+                                 const std::function<int()>& new_variable) {
+  if (end - begin == 1) return {inputs[begin]};
+  int middle = (begin + end) / 2;
+  auto left =
+      build_totalizer(solver, inputs, begin, middle, limit, new_variable);
+  auto right = build_totalizer(solver, inputs, middle, end, limit, new_variable);
+  std::vector<int> outputs(std::min<int>(left.size() + right.size(), limit));
+  for (int& output : outputs) output = new_variable();
+  // at least i from the left and at least j from the right give at least
+  // i + j, counts above the limit are all sent to the last output
+  for (int i = 0; i <= left.size(); i++)
+    for (int j = 0; j <= right.size(); j++) {
+      if (i + j == 0) continue;
+      int output = outputs[std::min<int>(i + j, outputs.size()) - 1];
+      if (i == 0)
+        solver.add_clause({-right[j - 1], output});
+      else if (j == 0)
+        solver.add_clause({-left[i - 1], output});
+      else
+        solver.add_clause({-left[i - 1], -right[j - 1], output});
+    }
+  return outputs;
+}
+
+std::vector<int> add_totalizer(SatSolver& solver,
+                               const std::vector<int>& inputs, int limit,
+                               const std::function<int()>& new_variable) {
+  if (inputs.empty() || limit <= 0) return {};
+  return build_totalizer(solver, inputs, 0, inputs.size(), limit,
+                         new_variable);
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sat/sat_solver.hpp"
+
+// serves the jobs of SatWorkerPool on stdin/stdout, see sat_worker_pool.hpp
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::unique_ptr<SatSolver> solver;
+  std::vector<int> clause;
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (line.empty()) continue;
+    if (line[0] == 'j') {
+      std::istringstream iss(line.substr(1));
+      int with_proof = 0;
+      unsigned random_seed = 0;
+      long long conflict_budget = 0;
+      iss >> with_proof >> random_seed >> conflict_budget;
+      solver = make_sat_solver(SatBackend::GLUCOSE_LIBRARY, with_proof == 1);
+      if (random_seed != 0) solver->set_random_seed(random_seed);
+      solver->set_conflict_budget(conflict_budget);
+      continue;
+    }
+    if (line[0] == 'u') {
+      if (solver == nullptr) return 1;
+      long long conflict_budget = 0;
+      std::istringstream(line.substr(1)) >> conflict_budget;
+      solver->set_conflict_budget(conflict_budget);
+      continue;
+    }
+    if (solver == nullptr) return 1;
+    bool is_command = line[0] == 'a' || line[0] == 'p';
+    std::istringstream iss(is_command ? line.substr(1) : line);
+    clause.clear();
+    int lit;
+    while (iss >> lit && lit != 0) clause.push_back(lit);
+    if (line[0] == 'p') {
+      solver->set_phase_hints(clause);
+      continue;
+    }
+    if (line[0] != 'a') {
+      solver->add_clause(clause);
+      continue;
+    }
+    auto result = solver->solve(clause);
+    if (result.result == GlucoseResultType::SAT) {
+      std::cout << "s SATISFIABLE\nv";
+      for (int lit : result.numbers) std::cout << " " << lit;
+      std::cout << " 0\n";
+    } else if (result.result == GlucoseResultType::UNKNOWN) {
+      std::cout << "s UNKNOWN\n";
+    } else {
+      std::cout << "s UNSATISFIABLE\nf";
+      for (int lit : result.failed_assumptions) std::cout << " " << lit;
+      std::cout << " 0\n";
+      for (const auto& proof_line : result.proof_lines)
+        std::cout << "r " << proof_line << "\n";
+    }
+    std::cout << "c " << result.conflicts << "\n";
+    // the solver is kept for a following u job of the same formula
+    std::cout << "e" << std::endl;
+  }
+  return 0;
+}
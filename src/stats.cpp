@@ -16,17 +16,21 @@
 #include "core/csv.hpp"
 #include "core/graph/file_loader.hpp"
 #include "core/graph/graph.hpp"
+#include "core/thread_pool.hpp"
 #include "orthogonal/drawing_builder.hpp"
 #include "orthogonal/drawing_stats.hpp"
 #include "orthogonal/file_loader.hpp"
 
 std::unordered_set<std::string> graphs_already_in_csv;
 int total_fails = 0;
+int total_budget_exhausted = 0;
+int total_discarded_blocks = 0;
 
 auto test_shape_metrics_approach(const Graph& graph,
-                                 const std::string& svg_output_filename) {
+                                 const std::string& svg_output_filename,
+                                 const DrawingOptions& options) {
   auto start = std::chrono::high_resolution_clock::now();
-  DrawingResult result = make_orthogonal_drawing_sperimental(graph);
+  DrawingResult result = make_orthogonal_drawing_sperimental(graph, options);
   auto end = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = end - start;
   node_positions_to_svg(result.positions, *result.augmented_graph,
@@ -49,7 +53,8 @@ auto test_ogdf_approach(const Graph& graph,
 void save_stats(std::ofstream& results_file,
                 const DrawingResult& results_shape_metrics,
                 double shape_metrics_time, const OGDFResult& results_ogdf,
-                double ogdf_time, const std::string& graph_name) {
+                double ogdf_time, const std::string& graph_name,
+                const DrawingOptions& options) {
   auto stats_shape_metrics =
       compute_all_orthogonal_stats(results_shape_metrics);
   results_file << graph_name << ",";
@@ -73,76 +78,104 @@ void save_stats(std::ofstream& results_file,
   results_file << ogdf_time << ",";
   results_file << results_shape_metrics.initial_number_of_cycles << ",";
   results_file << results_shape_metrics.number_of_added_cycles << ",";
-  results_file << results_shape_metrics.number_of_useless_bends;
+  results_file << results_shape_metrics.number_of_useless_bends << ",";
+  results_file << sat_backend_to_string(options.shape_options.sat_backend)
+               << ",";
+  results_file << options.shape_options.incremental << ",";
+  results_file << direction_encoding_to_string(
+                      options.shape_options.direction_encoding)
+               << ",";
+  results_file << options.shape_options.minimize_bends << ",";
+  results_file << options.shape_options.portfolio_size << ",";
+  results_file << options.shape_options.corners_per_round << ",";
+  results_file << options.add_all_conflicting_cycles << ",";
+  results_file << options.shape_options.break_symmetries << ",";
+  results_file << cycle_basis_type_to_string(options.cycle_basis) << ",";
+  results_file << options.solve_blocks_in_parallel << ",";
+  results_file << results_shape_metrics.sat_stats.number_of_solves << ",";
+  results_file << results_shape_metrics.sat_stats.number_of_variables << ",";
+  results_file << results_shape_metrics.sat_stats.number_of_clauses << ",";
+  results_file << results_shape_metrics.sat_stats.number_of_conflicts << ",";
+  results_file << results_shape_metrics.sat_budget_exhausted << ",";
+  results_file << results_shape_metrics.sat_stats.number_of_unproven_optima
+               << ",";
+  results_file << results_shape_metrics.has_discarded_blocks << ",";
+  results_file << results_shape_metrics.sat_stats.solve_time;
   results_file << std::endl;
 }
 
 void compare_approaches_in_folder(std::string& folder_path,
                                   std::ofstream& results_file,
-                                  std::string& output_svgs_folder) {
+                                  std::string& output_svgs_folder,
+                                  const DrawingOptions& options) {
   auto txt_files = collect_txt_files(folder_path);
   std::atomic<int> number_of_comparisons_done{0};
   std::mutex input_output_lock;
-  std::atomic<int> index{0};
-  unsigned num_threads = std::thread::hardware_concurrency();
-  std::vector<std::thread> threads;
-  for (unsigned i = 0; i < num_threads; ++i) {
-    threads.emplace_back([&]() {
-      while (true) {
-        int current = index.fetch_add(1, std::memory_order_relaxed);
-        if (current >= txt_files.size()) break;
-        const auto& entry_path = txt_files[current];
-        const std::string graph_filename =
-            std::filesystem::path(entry_path).stem().string();
-        int current_number =
-            number_of_comparisons_done.fetch_add(1, std::memory_order_relaxed);
-        if (graphs_already_in_csv.contains(graph_filename)) continue;
-        std::unique_ptr<Graph> graph = load_graph_from_txt_file(entry_path);
-        if (!is_graph_connected(*graph)) {
-          std::lock_guard<std::mutex> lock(input_output_lock);
-          std::cerr << "Graph " << graph_filename
-                    << " is not connected, skipping." << std::endl;
-          continue;
-        }
-        {
-          std::lock_guard<std::mutex> lock(input_output_lock);
-          std::cout << "Processing comparison #" << current_number << " - "
-                    << graph_filename << std::endl;
-        }
-        const std::string svg_output_filename_shape_metrics =
-            output_svgs_folder + graph_filename + "_shape_metrics.svg";
-        const std::string svg_output_filename_ogdf =
-            output_svgs_folder + graph_filename + "_ogdf.svg";
-        try {
-          auto result_shape_metrics = test_shape_metrics_approach(
-              *graph, svg_output_filename_shape_metrics);
-          auto result_ogdf =
-              test_ogdf_approach(*graph, svg_output_filename_ogdf);
-          {
-            std::lock_guard<std::mutex> lock(input_output_lock);
-            save_stats(results_file, result_shape_metrics.first,
-                       result_shape_metrics.second, result_ogdf.first,
-                       result_ogdf.second, graph_filename);
-          }
-        } catch (const std::exception& e) {
-          std::lock_guard<std::mutex> lock(input_output_lock);
-          std::cerr << "Error processing graph " << graph_filename << std::endl;
-          if (std::string(e.what()) != "Graph contains cycle") {
-            std::cerr << "Error: " << e.what() << std::endl;
-            throw;
-          } else {
-            std::cout << "Graph contains cycle, skipping." << std::endl;
-            total_fails++;
-          }
-        }
+  // the drawings share the threads of the pool with their blocks
+  ThreadPool& pool = get_thread_pool();
+  pool.run(txt_files.size(), [&](int current) {
+    const auto& entry_path = txt_files[current];
+    const std::string graph_filename =
+        std::filesystem::path(entry_path).stem().string();
+    int current_number =
+        number_of_comparisons_done.fetch_add(1, std::memory_order_relaxed);
+    if (graphs_already_in_csv.contains(graph_filename)) return;
+    std::unique_ptr<Graph> graph = load_graph_from_txt_file(entry_path);
+    if (!is_graph_connected(*graph)) {
+      std::lock_guard<std::mutex> lock(input_output_lock);
+      std::cerr << "Graph " << graph_filename
+                << " is not connected, skipping." << std::endl;
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(input_output_lock);
+      std::cout << "Processing comparison #" << current_number << " - "
+                << graph_filename << std::endl;
+    }
+    const std::string svg_output_filename_shape_metrics =
+        output_svgs_folder + graph_filename + "_shape_metrics.svg";
+    const std::string svg_output_filename_ogdf =
+        output_svgs_folder + graph_filename + "_ogdf.svg";
+    try {
+      auto result_shape_metrics = test_shape_metrics_approach(
+          *graph, svg_output_filename_shape_metrics, options);
+      auto result_ogdf = test_ogdf_approach(*graph, svg_output_filename_ogdf);
+      {
+        std::lock_guard<std::mutex> lock(input_output_lock);
+        save_stats(results_file, result_shape_metrics.first,
+                   result_shape_metrics.second, result_ogdf.first,
+                   result_ogdf.second, graph_filename, options);
+        if (result_shape_metrics.first.sat_budget_exhausted)
+          total_budget_exhausted++;
+        if (result_shape_metrics.first.has_discarded_blocks)
+          total_discarded_blocks++;
       }
-    });
-  }
-  for (auto& t : threads)
-    if (t.joinable()) t.join();
+    } catch (const DrawingBudgetExhausted&) {
+      std::lock_guard<std::mutex> lock(input_output_lock);
+      std::cout << "Graph " << graph_filename
+                << " used up its SAT budget, skipping." << std::endl;
+      total_budget_exhausted++;
+      total_fails++;
+    } catch (const std::exception& e) {
+      std::lock_guard<std::mutex> lock(input_output_lock);
+      std::cerr << "Error processing graph " << graph_filename << std::endl;
+      if (std::string(e.what()) != "Graph contains cycle") {
+        std::cerr << "Error: " << e.what() << std::endl;
+        throw;
+      } else {
+        std::cout << "Graph contains cycle, skipping." << std::endl;
+        total_fails++;
+      }
+    }
+  });
   std::cout << "All comparisons done." << std::endl;
-  std::cout << "Threads used: " << num_threads << std::endl;
+  std::cout << "Threads used: " << pool.get_number_of_threads() + 1
+            << std::endl;
   std::cout << "Total fails: " << total_fails << std::endl;
+  std::cout << "Total SAT budgets exhausted: " << total_budget_exhausted
+            << std::endl;
+  std::cout << "Total drawings that discarded their blocks: "
+            << total_discarded_blocks << std::endl;
   std::cout << "Total comparisons: " << number_of_comparisons_done.load() << std::endl;
 }
 
@@ -170,7 +203,25 @@ void initialize_csv_file(std::ofstream& result_file) {
               << "ogdf_time,"
               << "shape_metrics_initial_number_cycles,"
               << "shape_metrics_number_added_cycles,"
-              << "shape_metrics_number_useless_bends" << std::endl;
+              << "shape_metrics_number_useless_bends,"
+              << "shape_metrics_sat_backend,"
+              << "shape_metrics_incremental,"
+              << "shape_metrics_direction_encoding,"
+              << "shape_metrics_minimize_bends,"
+              << "shape_metrics_sat_portfolio_size,"
+              << "shape_metrics_corners_per_round,"
+              << "shape_metrics_all_conflicting_cycles,"
+              << "shape_metrics_break_symmetries,"
+              << "shape_metrics_cycle_basis,"
+              << "shape_metrics_parallel_blocks,"
+              << "shape_metrics_sat_solves,"
+              << "shape_metrics_cnf_variables,"
+              << "shape_metrics_cnf_clauses,"
+              << "shape_metrics_sat_conflicts,"
+              << "shape_metrics_sat_budget_exhausted,"
+              << "shape_metrics_unproven_optima,"
+              << "shape_metrics_discarded_blocks,"
+              << "shape_metrics_sat_time" << std::endl;
 }
 
 void compare_approaches(const Config& config) {
@@ -212,8 +263,40 @@ void compare_approaches(const Config& config) {
       return;
     }
   std::string test_graphs_folder = config.get("test_graphs_folder");
+  DrawingOptions options;
+  options.shape_options.sat_backend =
+      string_to_sat_backend(config.get("sat_backend"));
+  options.shape_options.incremental = config.get("incremental_shape") == "true";
+  options.shape_options.split_from_proof =
+      config.get("split_from_proof") == "true";
+  options.shape_options.direction_encoding =
+      string_to_direction_encoding(config.get("direction_encoding"));
+  options.shape_options.minimize_bends = config.get("minimize_bends") == "true";
+  options.shape_options.portfolio_size =
+      std::stoi(config.get("sat_portfolio_size"));
+  options.shape_options.corners_per_round =
+      std::stoi(config.get("corners_per_round"));
+  options.add_all_conflicting_cycles =
+      config.get("all_conflicting_cycles") == "true";
+  options.shape_options.break_symmetries =
+      config.get("break_symmetries") == "true";
+  options.cycle_basis = string_to_cycle_basis_type(config.get("cycle_basis"));
+  options.solve_blocks_in_parallel = config.get("parallel_blocks") == "true";
+  options.shape_options.conflicts_per_solve =
+      std::stoll(config.get("conflicts_per_solve"));
+  options.shape_options.seconds_per_solve =
+      std::stod(config.get("seconds_per_solve"));
+  options.shape_options.seconds_per_drawing =
+      std::stod(config.get("seconds_per_drawing"));
+  if (options.shape_options.incremental &&
+      options.shape_options.minimize_bends) {
+    std::cerr << "Error: incremental_shape and minimize_bends cannot both be "
+                 "true"
+              << std::endl;
+    return;
+  }
   compare_approaches_in_folder(test_graphs_folder, result_file,
-                               output_svgs_folder);
+                               output_svgs_folder, options);
   std::cout << std::endl;
   result_file.close();
 }
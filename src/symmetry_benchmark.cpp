@@ -0,0 +1,26 @@
+#include <iostream>
+#include <vector>
+
+#include "orthogonal/drawing_benchmark.hpp"
+#include "sat/sat_solver.hpp"
+
+// draws every graph of the folder without and with the symmetry-breaking
+// clauses, one csv row per graph and setting, then the totals of each
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <graphs folder> [sat backend]"
+              << std::endl;
+    return 1;
+  }
+  const SatBackend backend =
+      (argc > 2) ? string_to_sat_backend(argv[2]) : DEFAULT_SAT_BACKEND;
+  std::vector<DrawingSetting> settings;
+  for (bool break_symmetries : {false, true}) {
+    DrawingOptions options;
+    options.shape_options.sat_backend = backend;
+    options.shape_options.break_symmetries = break_symmetries;
+    settings.push_back({break_symmetries ? "true" : "false", options});
+  }
+  run_drawing_benchmark(argv[1], "break_symmetries", settings);
+  return 0;
+}